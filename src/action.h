@@ -2,6 +2,8 @@
 #define ACTION_
 
 #include "common.h"
+#include "meter.h"
+#include "output_group.h"
 
 struct Action {
   action_type type;
@@ -22,4 +24,42 @@ struct OutputAction {
   uint8_t port_id;
 };
 
+struct OutputGroupAction {
+  action_type type;
+  uint8_t nb_ports;
+  uint8_t port_ids[kMAX_GROUP_PORTS];
+};
+
+struct MeterAction {
+  action_type type;
+  Meter *meter;
+};
+
+struct CaptureAction {
+  action_type type;
+  int capture_id;
+};
+
+struct MirrorAction {
+  action_type type;
+  uint8_t port_id;
+  uint16_t truncate_len;   // 0 - packet isn't truncated
+};
+
+struct SetDscpAction {
+  action_type type;
+  uint8_t dscp;
+};
+
+struct SetEthAction {
+  action_type type;
+  ether_addr addr;
+};
+
+struct SampleAction {
+  action_type type;
+  uint32_t rate;   // one of rate packets (or flows) is sampled
+  bool by_flow;
+};
+
 #endif // ACTION_
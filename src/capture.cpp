@@ -0,0 +1,161 @@
+#include "capture.h"
+#include <glog/logging.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+
+static constexpr uint32_t kPCAP_MAGIC = 0xa1b2c3d4;  // microsecond timestamps
+static constexpr uint32_t kPCAP_SNAPLEN = 65535;
+static constexpr uint32_t kPCAP_LINKTYPE_ETHERNET = 1;
+// Record header and segments of each packet
+static constexpr int kCAPTURE_MAX_IOV = 1024;
+
+struct PcapFileHeader {
+  uint32_t magic;
+  uint16_t version_major;
+  uint16_t version_minor;
+  int32_t thiszone;
+  uint32_t sigfigs;
+  uint32_t snaplen;
+  uint32_t linktype;
+};
+
+struct PcapRecordHeader {
+  uint32_t ts_sec;
+  uint32_t ts_usec;
+  uint32_t incl_len;
+  uint32_t orig_len;
+};
+
+PacketCapture::PacketCapture() : nb_files_(0), base_us_(0), base_tsc_(0), tsc_hz_(0) {}
+
+PacketCapture::~PacketCapture() {
+  Close();
+}
+
+PacketCapture &PacketCapture::Instance() {
+  static PacketCapture instance;
+
+  return instance;
+}
+
+// Returns id of capture or -1 on error, the same file gets the same id
+int PacketCapture::Register(const std::string &name) {
+  std::lock_guard<std::mutex> lock(lock_);
+  const uint16_t nb_files = nb_files_.load(std::memory_order_relaxed);
+  for (uint16_t i = 0; i < nb_files; ++i) {
+    if (files_[i].name == name) {
+      return i;
+    }
+  }
+  if (nb_files == kCAPTURE_MAX_FILES) {
+    LOG(ERROR) << "Too many capture files, limit is " << kCAPTURE_MAX_FILES;
+    return -1;
+  }
+
+  if (nb_files == 0) {
+    timeval tv;
+    gettimeofday(&tv, nullptr);
+    base_us_ = (uint64_t)tv.tv_sec * US_PER_S + tv.tv_usec;
+    base_tsc_ = rte_rdtsc();
+    tsc_hz_ = rte_get_tsc_hz();
+  }
+
+  CaptureFile &file = files_[nb_files];
+  file.fd = open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file.fd < 0) {
+    LOG(ERROR) << "Can't open capture file " << name;
+    return -1;
+  }
+  const PcapFileHeader header = {kPCAP_MAGIC, 2, 4, 0, 0, kPCAP_SNAPLEN, kPCAP_LINKTYPE_ETHERNET};
+  if (write(file.fd, &header, sizeof(header)) != sizeof(header)) {
+    LOG(ERROR) << "Can't write capture file " << name;
+    close(file.fd);
+    return -1;
+  }
+  if (!file.ring.Create("CAPTURE_" + std::to_string(nb_files), kCAPTURE_RING_SIZE)) {
+    LOG(ERROR) << "Can't create ring for capture file " << name;
+    close(file.fd);
+    return -1;
+  }
+  file.name = name;
+  nb_files_.store(nb_files + 1, std::memory_order_release);
+  LOG(INFO) << "Capture to " << name << " started";
+
+  return nb_files;
+}
+
+bool PacketCapture::Enqueue(const int id, rte_mbuf *m, const uint64_t cur_tsc) {
+  return files_[id].ring.Enqueue(m, cur_tsc);
+}
+
+void PacketCapture::Write() {
+  rte_mbuf *pkts[kCLONE_RING_BURST];
+  const uint16_t nb_files = nb_files_.load(std::memory_order_acquire);
+  for (uint16_t i = 0; i < nb_files; ++i) {
+    CaptureFile &file = files_[i];
+    unsigned n;
+    while ((n = file.ring.Dequeue(pkts, kCLONE_RING_BURST)) > 0) {
+      if (!WriteBurst(file, pkts, n)) {
+        LOG(WARNING) << "Can't write " << n << " packets to capture file " << file.name;
+      }
+      for (unsigned j = 0; j < n; ++j) {
+        CloneRing::Release(pkts[j]);
+      }
+    }
+  }
+}
+
+void PacketCapture::Close() {
+  Write();
+  const uint16_t nb_files = nb_files_.load(std::memory_order_acquire);
+  for (uint16_t i = 0; i < nb_files; ++i) {
+    close(files_[i].fd);
+    files_[i].ring.Free();
+    LOG(INFO) << "Capture to " << files_[i].name << " finished";
+  }
+  nb_files_.store(0, std::memory_order_release);
+}
+
+// Record headers and packet segments are written by single system call
+bool PacketCapture::WriteBurst(CaptureFile &file, rte_mbuf **pkts, const uint16_t n) {
+  PcapRecordHeader headers[kCLONE_RING_BURST];
+  iovec iov[kCAPTURE_MAX_IOV];
+  int iov_count = 0;
+  size_t total_len = 0;
+
+  for (uint16_t i = 0; i < n; ++i) {
+    rte_mbuf *m = pkts[i];
+    // Record header is followed by up to all segments
+    if (iov_count + 1 + m->nb_segs > kCAPTURE_MAX_IOV) {
+      break;
+    }
+    PcapRecordHeader &header = headers[i];
+    TscToTimeval(m->udata64, header.ts_sec, header.ts_usec);
+    header.incl_len = RTE_MIN(m->pkt_len, kPCAP_SNAPLEN);
+    header.orig_len = m->pkt_len;
+    iov[iov_count].iov_base = &header;
+    iov[iov_count++].iov_len = sizeof(header);
+    total_len += sizeof(header);
+
+    uint32_t remain = header.incl_len;
+    for (rte_mbuf *seg = m; seg != nullptr && remain > 0; seg = seg->next) {
+      const uint32_t seg_len = RTE_MIN((uint32_t)seg->data_len, remain);
+      iov[iov_count].iov_base = rte_pktmbuf_mtod(seg, void *);
+      iov[iov_count++].iov_len = seg_len;
+      total_len += seg_len;
+      remain -= seg_len;
+    }
+  }
+
+  return writev(file.fd, iov, iov_count) == (ssize_t)total_len;
+}
+
+void PacketCapture::TscToTimeval(const uint64_t tsc, uint32_t &sec, uint32_t &usec) const {
+  const uint64_t us = base_us_ + (tsc - base_tsc_) / (tsc_hz_ / US_PER_S);
+  sec = us / US_PER_S;
+  usec = us % US_PER_S;
+}
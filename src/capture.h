@@ -0,0 +1,50 @@
+#ifndef CAPTURE_
+#define CAPTURE_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "clone_ring.h"
+
+static constexpr uint32_t kCAPTURE_RING_SIZE = 8192;   // must be power of 2
+static constexpr uint16_t kCAPTURE_MAX_FILES = 16;
+
+// Captures packets to pcap files. Processing lcores enqueue clones of packets (data isn't copied)
+// to ring of the file, writer (master lcore) drains rings to files, so processing never waits for disk.
+// Files are kept open across rules reloads, they are closed at exit.
+class PacketCapture {
+ public:
+  PacketCapture();
+  ~PacketCapture();
+
+  PacketCapture(const PacketCapture &) = delete;
+  PacketCapture &operator=(const PacketCapture &) = delete;
+  PacketCapture(PacketCapture &&) = delete;
+  PacketCapture &operator=(PacketCapture &&) = delete;
+
+  static PacketCapture &Instance();
+  int Register(const std::string &);
+  bool Enqueue(const int, rte_mbuf *, const uint64_t);
+  void Write();
+  void Close();
+
+ private:
+  struct CaptureFile {
+    std::string name;
+    int fd;
+    CloneRing ring;
+  };
+
+  bool WriteBurst(CaptureFile &, rte_mbuf **, const uint16_t);
+  void TscToTimeval(const uint64_t, uint32_t &, uint32_t &) const;
+
+  std::mutex lock_;        // protects registration only
+  CaptureFile files_[kCAPTURE_MAX_FILES];
+  std::atomic<uint16_t> nb_files_;
+  uint64_t base_us_;
+  uint64_t base_tsc_;
+  uint64_t tsc_hz_;
+};
+
+#endif // CAPTURE_
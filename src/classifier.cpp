@@ -0,0 +1,159 @@
+#include "classifier.h"
+#include <string>
+#include <rte_acl.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <glog/logging.h>
+
+#define ETHER_TYPE_VLAN_8021AD 0x88a8
+
+enum acl_field: uint8_t {
+  ACL_FIELD_PORT,
+  ACL_FIELD_PROTOCOL,
+  ACL_FIELD_VLAN,
+  ACL_FIELD_SRC_ADDR,
+  ACL_FIELD_DST_ADDR,
+  ACL_FIELD_SRC_PORT,
+  ACL_FIELD_DST_PORT,
+  ACL_FIELD_NUMBER,
+};
+
+RTE_ACL_RULE_DEF(AclRule, ACL_FIELD_NUMBER);
+
+// Fields with the same input index are grouped by 4 bytes, the first one must be 1 byte long
+static const rte_acl_field_def kACL_FIELDS[ACL_FIELD_NUMBER] = {
+  {RTE_ACL_FIELD_TYPE_BITMASK, sizeof(uint8_t), ACL_FIELD_PORT, 0, offsetof(AclKey, port_id)},
+  {RTE_ACL_FIELD_TYPE_BITMASK, sizeof(uint16_t), ACL_FIELD_PROTOCOL, 1, offsetof(AclKey, protocol)},
+  {RTE_ACL_FIELD_TYPE_BITMASK, sizeof(uint16_t), ACL_FIELD_VLAN, 1, offsetof(AclKey, vlan)},
+  {RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t), ACL_FIELD_SRC_ADDR, 2, offsetof(AclKey, src_addr)},
+  {RTE_ACL_FIELD_TYPE_MASK, sizeof(uint32_t), ACL_FIELD_DST_ADDR, 3, offsetof(AclKey, dst_addr)},
+  {RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t), ACL_FIELD_SRC_PORT, 4, offsetof(AclKey, src_port)},
+  {RTE_ACL_FIELD_TYPE_RANGE, sizeof(uint16_t), ACL_FIELD_DST_PORT, 4, offsetof(AclKey, dst_port)},
+};
+
+static constexpr uint16_t kVLAN_ID_MASK = 0x0fff;
+
+RuleConditions::RuleConditions()
+    : port_id(0), protocol(UNKNOWN), vlan(0),
+      src_addr(0), src_len(0), dst_addr(0), dst_len(0),
+      src_port_min(0), src_port_max(UINT16_MAX), dst_port_min(0), dst_port_max(UINT16_MAX) {}
+
+bool RuleConditions::operator==(const RuleConditions &other) const {
+  return port_id == other.port_id && protocol == other.protocol && vlan == other.vlan &&
+         src_addr == other.src_addr && src_len == other.src_len &&
+         dst_addr == other.dst_addr && dst_len == other.dst_len &&
+         src_port_min == other.src_port_min && src_port_max == other.src_port_max &&
+         dst_port_min == other.dst_port_min && dst_port_max == other.dst_port_max;
+}
+
+void FillAclKey(const rte_mbuf *m, const uint8_t port_id, const protocol_type protocol, AclKey &key) {
+  memset(&key, 0, sizeof(key));
+  key.port_id = port_id;
+  key.protocol = rte_cpu_to_be_16(protocol);
+
+  char buf[kMAX_HEADERS_LEN];
+  const uint16_t l3_offset = m->outer_l2_len + m->outer_l3_len + m->l2_len;
+  const uint16_t l4_offset = l3_offset + m->l3_len;
+  const uint16_t headers_len = RTE_MIN(l4_offset + m->l4_len, kMAX_HEADERS_LEN);
+  const char *data = (const char *)ReadMbufData(m, 0, headers_len, buf);
+  if (!data) {
+    return;
+  }
+
+  // Outer VLAN tag
+  const ether_hdr *eth = (const ether_hdr *)data;
+  if (eth->ether_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+      eth->ether_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN_8021AD)) {
+    key.vlan = ((const vlan_hdr *)(eth + 1))->vlan_tci & rte_cpu_to_be_16(kVLAN_ID_MASK);
+  }
+
+  // Addresses and ports are taken from inner headers of tunneled packets (only IPv4 is matched)
+  if (l3_offset + sizeof(ipv4_hdr) > headers_len || (data[l3_offset] >> 4) != 4) {
+    return;
+  }
+  const ipv4_hdr *ipv4 = (const ipv4_hdr *)(data + l3_offset);
+  key.src_addr = ipv4->src_addr;
+  key.dst_addr = ipv4->dst_addr;
+
+  // Non-first fragments don't have ports
+  if (m->l4_len >= 2*sizeof(uint16_t) && l4_offset + 2*sizeof(uint16_t) <= headers_len) {
+    key.src_port = *(const uint16_t *)(data + l4_offset);
+    key.dst_port = *(const uint16_t *)(data + l4_offset + sizeof(uint16_t));
+  }
+}
+
+Classifier::Classifier() : ctx_(nullptr) {}
+
+Classifier::~Classifier() {
+  if (ctx_) {
+    rte_acl_free(ctx_);
+  }
+}
+
+bool Classifier::Build(const std::vector<RuleConditions> &conditions) {
+  if (conditions.empty()) {
+    return true;
+  }
+
+  // Each rule table has own context, so name has to be unique
+  static uint32_t ctx_counter = 0;
+  const std::string name = "RULES_" + std::to_string(ctx_counter++);
+  rte_acl_param param;
+  param.name = name.c_str();
+  param.socket_id = SOCKET_ID_ANY;
+  param.rule_size = RTE_ACL_RULE_SZ(ACL_FIELD_NUMBER);
+  param.max_rule_num = conditions.size();
+  ctx_ = rte_acl_create(&param);
+  if (!ctx_) {
+    LOG(ERROR) << "Can't create ACL context";
+    return false;
+  }
+
+  for (uint32_t i = 0; i < conditions.size(); ++i) {
+    const RuleConditions &cond = conditions[i];
+    AclRule rule;
+    memset(&rule, 0, sizeof(rule));
+    rule.data.category_mask = 1;
+    // Rule which is the first in config wins
+    rule.data.priority = RTE_ACL_MAX_PRIORITY - i;
+    rule.data.userdata = i + 1;
+    rule.field[ACL_FIELD_PORT].value.u8 = cond.port_id;
+    rule.field[ACL_FIELD_PORT].mask_range.u8 = UINT8_MAX;
+    rule.field[ACL_FIELD_PROTOCOL].value.u16 = cond.protocol;
+    rule.field[ACL_FIELD_PROTOCOL].mask_range.u16 = UINT16_MAX;
+    rule.field[ACL_FIELD_VLAN].value.u16 = cond.vlan;
+    rule.field[ACL_FIELD_VLAN].mask_range.u16 = cond.vlan ? kVLAN_ID_MASK : 0;
+    rule.field[ACL_FIELD_SRC_ADDR].value.u32 = cond.src_addr;
+    rule.field[ACL_FIELD_SRC_ADDR].mask_range.u32 = cond.src_len;
+    rule.field[ACL_FIELD_DST_ADDR].value.u32 = cond.dst_addr;
+    rule.field[ACL_FIELD_DST_ADDR].mask_range.u32 = cond.dst_len;
+    rule.field[ACL_FIELD_SRC_PORT].value.u16 = cond.src_port_min;
+    rule.field[ACL_FIELD_SRC_PORT].mask_range.u16 = cond.src_port_max;
+    rule.field[ACL_FIELD_DST_PORT].value.u16 = cond.dst_port_min;
+    rule.field[ACL_FIELD_DST_PORT].mask_range.u16 = cond.dst_port_max;
+    if (rte_acl_add_rules(ctx_, (const rte_acl_rule *)&rule, 1) != 0) {
+      LOG(ERROR) << "Can't add rule to ACL context";
+      return false;
+    }
+  }
+
+  rte_acl_config config;
+  memset(&config, 0, sizeof(config));
+  config.num_categories = 1;
+  config.num_fields = ACL_FIELD_NUMBER;
+  memcpy(config.defs, kACL_FIELDS, sizeof(kACL_FIELDS));
+  if (rte_acl_build(ctx_, &config) != 0) {
+    LOG(ERROR) << "Can't build ACL context";
+    return false;
+  }
+
+  return true;
+}
+
+void Classifier::Classify(const uint8_t **data, uint32_t *results, const uint32_t num) const {
+  if (!ctx_) {
+    memset(results, 0, num*sizeof(uint32_t));
+    return;
+  }
+  rte_acl_classify(ctx_, data, results, num, 1);
+}
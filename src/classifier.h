@@ -0,0 +1,60 @@
+#ifndef CLASSIFIER_
+#define CLASSIFIER_
+
+#include <vector>
+#include "common.h"
+
+struct rte_acl_ctx;
+
+// Match conditions of single rule (addresses and ports are in host byte order)
+struct RuleConditions {
+  RuleConditions();
+  bool operator==(const RuleConditions &) const;
+
+  uint8_t port_id;
+  protocol_type protocol;
+  uint16_t vlan;       // 0 - any
+  uint32_t src_addr;
+  uint8_t src_len;     // 0 - any
+  uint32_t dst_addr;
+  uint8_t dst_len;     // 0 - any
+  uint16_t src_port_min;
+  uint16_t src_port_max;
+  uint16_t dst_port_min;
+  uint16_t dst_port_max;
+};
+
+// Classifier input built for every packet (multi-byte fields are in network byte order)
+struct AclKey {
+  uint8_t port_id;
+  uint8_t pad[3];
+  uint16_t protocol;
+  uint16_t vlan;
+  uint32_t src_addr;
+  uint32_t dst_addr;
+  uint16_t src_port;
+  uint16_t dst_port;
+};
+
+void FillAclKey(const rte_mbuf *, const uint8_t, const protocol_type, AclKey &);
+
+// Multi-field classifier based on rte_acl. Result of classification is index of
+// the first matched rule plus one, or 0 if nothing is matched.
+class Classifier {
+ public:
+  Classifier();
+  ~Classifier();
+
+  Classifier(const Classifier &) = delete;
+  Classifier &operator=(const Classifier &) = delete;
+  Classifier(Classifier &&) = delete;
+  Classifier &operator=(Classifier &&) = delete;
+
+  bool Build(const std::vector<RuleConditions> &);
+  void Classify(const uint8_t **, uint32_t *, const uint32_t) const;
+
+ private:
+  rte_acl_ctx *ctx_;
+};
+
+#endif // CLASSIFIER_
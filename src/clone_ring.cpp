@@ -0,0 +1,88 @@
+#include "clone_ring.h"
+#include <glog/logging.h>
+#include <atomic>
+#include <cassert>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+// Rx-mbufs referenced by clones in all rings, port->number of mbufs
+static std::atomic<uint32_t> pinned_mbufs[RTE_MAX_ETHPORTS];
+
+CloneRing::CloneRing() : mempool_(nullptr), ring_(nullptr) {}
+
+CloneRing::~CloneRing() {
+  Free();
+}
+
+bool CloneRing::Create(const std::string &name, const uint32_t size) {
+  // Ring keeps size-1 clones, optimal mempool size is power of 2 minus 1
+  const uint32_t nb_mbufs = RTE_MAX(2 * size - 1, size + kCLONE_RING_BURST);
+  const std::string pool_name = name + "_POOL";
+  mempool_ = rte_pktmbuf_pool_create(pool_name.c_str(), nb_mbufs, 32, 0, 0, SOCKET_ID_ANY);
+  if (!mempool_) {
+    LOG(ERROR) << "Can't create mempool " << pool_name;
+    return false;
+  }
+  // Any processing lcore may enqueue, the only reader is master lcore
+  ring_ = rte_ring_create(name.c_str(), size, SOCKET_ID_ANY, RING_F_SC_DEQ);
+  if (!ring_) {
+    LOG(ERROR) << "Can't create ring " << name;
+    rte_mempool_free(mempool_);
+    mempool_ = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+void CloneRing::Free() {
+  if (ring_) {
+    rte_mbuf *pkts[kCLONE_RING_BURST];
+    unsigned n;
+    while ((n = Dequeue(pkts, kCLONE_RING_BURST)) > 0) {
+      for (unsigned i = 0; i < n; ++i) {
+        Release(pkts[i]);
+      }
+    }
+    rte_ring_free(ring_);
+    ring_ = nullptr;
+  }
+  if (mempool_) {
+    rte_mempool_free(mempool_);
+    mempool_ = nullptr;
+  }
+}
+
+bool CloneRing::IsCreated() const {
+  return ring_ != nullptr;
+}
+
+bool CloneRing::Enqueue(rte_mbuf *m, const uint64_t udata) {
+  assert(m->port < RTE_MAX_ETHPORTS);
+  std::atomic<uint32_t> &pinned = pinned_mbufs[m->port];
+  if (pinned.fetch_add(m->nb_segs, std::memory_order_relaxed) + m->nb_segs > kCLONE_PORT_MBUFS) {
+    pinned.fetch_sub(m->nb_segs, std::memory_order_relaxed);
+    return false;
+  }
+  rte_mbuf *clone = rte_pktmbuf_clone(m, mempool_);
+  if (!clone) {
+    pinned.fetch_sub(m->nb_segs, std::memory_order_relaxed);
+    return false;
+  }
+  clone->udata64 = udata;
+  if (rte_ring_mp_enqueue(ring_, clone) != 0) {
+    Release(clone);
+    return false;
+  }
+
+  return true;
+}
+
+unsigned CloneRing::Dequeue(rte_mbuf **pkts, const unsigned n) {
+  return rte_ring_sc_dequeue_burst(ring_, (void **)pkts, n);
+}
+
+void CloneRing::Release(rte_mbuf *clone) {
+  pinned_mbufs[clone->port].fetch_sub(clone->nb_segs, std::memory_order_relaxed);
+  rte_pktmbuf_free(clone);
+}
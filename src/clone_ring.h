@@ -0,0 +1,40 @@
+#ifndef CLONE_RING_
+#define CLONE_RING_
+
+#include <string>
+#include <rte_ring.h>
+#include "common.h"
+
+static constexpr uint16_t kCLONE_RING_BURST = 64; // clones dequeued by reader at once
+static constexpr uint32_t kCLONE_PORT_MBUFS = 4096; // rx-mbufs of single port pinned by clones of all rings
+
+// Clones of packets (data isn't copied) passed from processing lcores to single reader.
+// Clones are allocated from own pool which holds the full ring and a burst taken by reader,
+// so enqueue fails only when the reader doesn't keep up. Each clone keeps its source rx-mbufs until
+// the reader releases it, their number is limited for each rx-port, so rx-mempool isn't exhausted.
+class CloneRing {
+ public:
+  CloneRing();
+  ~CloneRing();
+
+  CloneRing(const CloneRing &) = delete;
+  CloneRing &operator=(const CloneRing &) = delete;
+  CloneRing(CloneRing &&) = delete;
+  CloneRing &operator=(CloneRing &&) = delete;
+
+  // Size must be power of 2
+  bool Create(const std::string &, const uint32_t);
+  void Free();
+  bool IsCreated() const;
+  // Packet isn't modified after it's cloned, udata64 of clone keeps caller's value
+  bool Enqueue(rte_mbuf *, const uint64_t);
+  unsigned Dequeue(rte_mbuf **, const unsigned);
+  // Frees dequeued clone, so its source mbufs return to the limit of rx-port
+  static void Release(rte_mbuf *);
+
+ private:
+  rte_mempool *mempool_;   // indirect mbufs for clones
+  rte_ring *ring_;
+};
+
+#endif // CLONE_RING_
@@ -2,14 +2,80 @@
 #include <sstream>
 #include <getopt.h>
 #include "cmd_args.h"
-#include "common.h"
+#include "port.h"
+#include "flow_table.h"
+#include <rte_mempool.h>
 
 static const struct option long_opts[] = {
   {"config", required_argument, nullptr, 0},
   {"stats-interval", required_argument, nullptr, 0},
+  {"max-pkt-len", required_argument, nullptr, 0},
+  {"parse-tunnels", no_argument, nullptr, 0},
+  {"egress-sched", no_argument, nullptr, 0},
+  {"tx-retries", required_argument, nullptr, 0},
+  {"burst", required_argument, nullptr, 0},
+  {"rxd", required_argument, nullptr, 0},
+  {"txd", required_argument, nullptr, 0},
+  {"mbufs", required_argument, nullptr, 0},
+  {"mbuf-cache", required_argument, nullptr, 0},
+  {"mempool-per-port", no_argument, nullptr, 0},
+  {"port-lcore-map", required_argument, nullptr, 0},
+  {"adaptive-poll", no_argument, nullptr, 0},
+  {"top-talkers", no_argument, nullptr, 0},
+  {"cardinality", no_argument, nullptr, 0},
+  {"ipfix", required_argument, nullptr, 0},
+  {"flow-table-size", required_argument, nullptr, 0},
   {nullptr, no_argument, nullptr, 0},
 };
 
+static unsigned long ParseNumber(const char *name, const char *str, const unsigned long min, const unsigned long max) {
+  unsigned long ret;
+  if (!ParseInt(str, ret) || ret < min || ret > max) {
+    std::stringstream error_msg;
+    error_msg << "Invalid " << name << ". Used \"" << str << '"';
+    throw std::invalid_argument(error_msg.str());
+  }
+
+  return ret;
+}
+
+// Format: port:lcore[,port:lcore...]
+static void ParsePortLcoreMap(const char *str, std::map<uint8_t, unsigned> &port_lcore_map) {
+  std::stringstream error_msg;
+  error_msg << "Invalid port-lcore-map. Used \"" << str << '"';
+
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto delim = item.find(':');
+    unsigned long port_id, lcore_id;
+    if (delim == std::string::npos || !ParseInt(item.substr(0, delim), port_id) || port_id >= RTE_MAX_ETHPORTS ||
+        !ParseInt(item.substr(delim + 1), lcore_id) || lcore_id >= RTE_MAX_LCORE ||
+        !port_lcore_map.emplace(port_id, lcore_id).second) {
+      throw std::invalid_argument(error_msg.str());
+    }
+  }
+  if (port_lcore_map.empty()) {
+    throw std::invalid_argument(error_msg.str());
+  }
+}
+
+// Format: a.b.c.d:port
+static void ParseCollector(const char *str, uint32_t &addr, uint16_t &port) {
+  const std::string collector(str);
+  const auto delim = collector.find(':');
+  uint8_t prefix_len;
+  unsigned long port_value;
+  if (delim == std::string::npos || !ParseIpv4Prefix(collector.substr(0, delim), addr, prefix_len) ||
+      prefix_len != 32 || !ParseInt(collector.substr(delim + 1), port_value) ||
+      port_value == 0 || port_value > UINT16_MAX) {
+    std::stringstream error_msg;
+    error_msg << "Invalid ipfix. Used \"" << str << '"';
+    throw std::invalid_argument(error_msg.str());
+  }
+  port = port_value;
+}
+
 CmdArgs ParseArgs(int argc, char *argv[]) {
   CmdArgs ret;
 
@@ -31,6 +97,65 @@ CmdArgs ParseArgs(int argc, char *argv[]) {
       }
       ret.stats_interval = stats_interval;
     }
+    else if (!strcmp("max-pkt-len", long_opts[long_index].name)) {
+      unsigned long max_pkt_len;
+      if (!ParseInt(optarg, max_pkt_len) || max_pkt_len > UINT16_MAX) {
+        std::stringstream error_msg;
+        error_msg << "Invalid max-pkt-len. Used \"" << optarg << '"';
+        throw std::invalid_argument(error_msg.str());
+      }
+      ret.max_pkt_len = max_pkt_len;
+    }
+    else if (!strcmp("parse-tunnels", long_opts[long_index].name)) {
+      ret.parse_tunnels = true;
+    }
+    else if (!strcmp("egress-sched", long_opts[long_index].name)) {
+      ret.egress_sched = true;
+    }
+    else if (!strcmp("tx-retries", long_opts[long_index].name)) {
+      ret.tx_retries = ParseNumber("tx-retries", optarg, 0, UINT16_MAX);
+    }
+    else if (!strcmp("burst", long_opts[long_index].name)) {
+      ret.burst_size = ParseNumber("burst", optarg, 1, kMAX_PKTS_IN_QUEUE);
+    }
+    else if (!strcmp("rxd", long_opts[long_index].name)) {
+      ret.nb_rxd = ParseNumber("rxd", optarg, 1, UINT16_MAX);
+    }
+    else if (!strcmp("txd", long_opts[long_index].name)) {
+      ret.nb_txd = ParseNumber("txd", optarg, 1, UINT16_MAX);
+    }
+    else if (!strcmp("mbufs", long_opts[long_index].name)) {
+      ret.nb_mbufs = ParseNumber("mbufs", optarg, 0, UINT32_MAX);
+    }
+    else if (!strcmp("mbuf-cache", long_opts[long_index].name)) {
+      ret.mbuf_cache = ParseNumber("mbuf-cache", optarg, 0, RTE_MEMPOOL_CACHE_MAX_SIZE);
+    }
+    else if (!strcmp("mempool-per-port", long_opts[long_index].name)) {
+      ret.mempool_per_port = true;
+    }
+    else if (!strcmp("port-lcore-map", long_opts[long_index].name)) {
+      ParsePortLcoreMap(optarg, ret.port_lcore_map);
+    }
+    else if (!strcmp("adaptive-poll", long_opts[long_index].name)) {
+      ret.adaptive_poll = true;
+    }
+    else if (!strcmp("top-talkers", long_opts[long_index].name)) {
+      ret.top_talkers = true;
+    }
+    else if (!strcmp("cardinality", long_opts[long_index].name)) {
+      ret.cardinality = true;
+    }
+    else if (!strcmp("ipfix", long_opts[long_index].name)) {
+      ParseCollector(optarg, ret.ipfix_addr, ret.ipfix_port);
+    }
+    else if (!strcmp("flow-table-size", long_opts[long_index].name)) {
+      ret.flow_table_size = ParseNumber("flow-table-size", optarg, kFLOW_BUCKET_ENTRIES, 1U << 24);
+      if (!rte_is_power_of_2(ret.flow_table_size)) {
+        std::stringstream error_msg;
+        error_msg << "Invalid flow-table-size. Used \"" << optarg << '"';
+        throw std::invalid_argument(error_msg.str());
+      }
+    }
   }
 
   return ret;
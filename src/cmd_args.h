@@ -1,9 +1,28 @@
 #ifndef CMD_ARGS_
 #define CMD_ARGS_
 
+#include <map>
+
 struct CmdArgs {
   const char *config_file = "";
   uint16_t stats_interval = 0;
+  uint16_t max_pkt_len = 0; // 0 - jumbo frames are disabled
+  bool parse_tunnels = false;
+  bool egress_sched = false;
+  uint16_t tx_retries = 3; // attempts to send after NIC didn't accept all packets
+  uint16_t burst_size = 32;
+  uint16_t nb_rxd = 1024;
+  uint16_t nb_txd = 512;
+  uint32_t nb_mbufs = 0;    // 0 - mempool size is computed
+  uint16_t mbuf_cache = 32;
+  bool mempool_per_port = false; // false - mempool is shared by ports of the same socket
+  bool adaptive_poll = false; // true - idle lcores pause, sleep and wait for rx interrupts
+  bool top_talkers = false; // true - top flows of each protocol are printed with statistics
+  bool cardinality = false; // true - distinct flows and clients of each protocol are printed with statistics
+  uint32_t ipfix_addr = 0; // IPFIX collector (host order)
+  uint16_t ipfix_port = 0; // 0 - flows aren't exported
+  uint32_t flow_table_size = 16384; // flows tracked by each port for export (power of 2)
+  std::map<uint8_t, unsigned> port_lcore_map; // port->lcore, other ports are placed automatically
 };
 
 CmdArgs ParseArgs(int argc, char *argv[]);
@@ -1,4 +1,5 @@
 #include "common.h"
+#include <arpa/inet.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_tcp.h>
@@ -6,6 +7,46 @@
 #include <glog/logging.h>
 
 #define ETHER_TYPE_VLAN_8021AD 0x88a8
+#define ETHER_TYPE_MPLS 0x8847
+#define ETHER_TYPE_MPLS_MULTICAST 0x8848
+#ifndef ETHER_TYPE_TEB
+#define ETHER_TYPE_TEB 0x6558
+#endif
+
+static constexpr auto kMAX_VLAN_TAGS = 8;
+static constexpr auto kMAX_MPLS_LABELS = 8;
+static constexpr uint32_t kMPLS_BOS_FLAG = 0x00000100;
+// l2_len of tunneled packet is limited by mbuf field width
+static constexpr auto kMAX_TUNNEL_L2_LEN = 127;
+/* Tunnels */
+static constexpr uint16_t kVXLAN_PORT = 4789;
+static constexpr uint16_t kVXLAN_HDR_LEN = 8;
+static constexpr uint8_t kVXLAN_VNI_FLAG = 0x08;
+static constexpr uint16_t kGTPU_PORT = 2152;
+static constexpr uint16_t kGTPU_HDR_LEN = 8;
+static constexpr uint8_t kGTPU_VERSION_MASK = 0xe0;
+static constexpr uint8_t kGTPU_VERSION_1 = 0x20;
+static constexpr uint8_t kGTPU_OPT_FLAGS = 0x07; // E, S, PN
+static constexpr uint8_t kGTPU_TYPE_GPDU = 0xff;
+static constexpr uint8_t kGTPU_MAX_EXT_HDRS = 4;
+static constexpr uint16_t kGRE_HDR_LEN = 4;
+static constexpr uint16_t kGRE_CHECKSUM_FLAG = 0x8000;
+static constexpr uint16_t kGRE_ROUTING_FLAG = 0x4000;
+static constexpr uint16_t kGRE_KEY_FLAG = 0x2000;
+static constexpr uint16_t kGRE_SEQUENCE_FLAG = 0x1000;
+static constexpr uint16_t kGRE_VERSION_MASK = 0x0007;
+/* IPv6 extension headers */
+static constexpr uint8_t kMAX_IPV6_EXT_HDRS = 8;
+static constexpr uint16_t kIPV6_FRAG_HDR_LEN = 8;
+static constexpr uint16_t kIPV6_FRAG_OFFSET_MASK = 0xfff8;
+static constexpr uint16_t kIPV6_FRAG_MF_FLAG = 0x0001;
+
+const char *GetProtocolName(const protocol_type protocol) {
+  static const char *protocol_names[] = {"HTTP", "SIP", "RTP", "RTSP", "UNKNOWN"};
+  static_assert(sizeof(protocol_names) / sizeof(protocol_names[0]) == UNKNOWN + 1, "Name of each protocol is needed");
+
+  return protocol < UNKNOWN ? protocol_names[protocol] : protocol_names[UNKNOWN];
+}
 
 bool ParseInt(const std::string &str, unsigned long &ret) {
   try {
@@ -22,32 +63,413 @@ bool ParseInt(const std::string &str, unsigned long &ret) {
   return true;
 }
 
+// Parses "a.b.c.d[/len]", address is returned in host byte order
+bool ParseIpv4Prefix(const std::string &str, uint32_t &addr, uint8_t &len) {
+  auto pos = str.find("/");
+  unsigned long ret = 32;
+  if (pos != std::string::npos && (!ParseInt(str.substr(pos+1), ret) || ret > 32)) {
+    return false;
+  }
+  in_addr in;
+  if (inet_pton(AF_INET, str.substr(0, pos).c_str(), &in) != 1) {
+    return false;
+  }
+  len = (uint8_t)ret;
+  addr = len ? rte_be_to_cpu_32(in.s_addr) & ~((1ULL << (32 - len)) - 1) : 0;
+
+  return true;
+}
+
+// Parses "min[-max]"
+bool ParseRange(const std::string &str, uint16_t &min, uint16_t &max) {
+  auto pos = str.find("-");
+  unsigned long min_ret, max_ret;
+  if (!ParseInt(str.substr(0, pos), min_ret)) {
+    return false;
+  }
+  max_ret = min_ret;
+  if (pos != std::string::npos && !ParseInt(str.substr(pos+1), max_ret)) {
+    return false;
+  }
+  if (min_ret > max_ret || max_ret > UINT16_MAX) {
+    return false;
+  }
+  min = (uint16_t)min_ret;
+  max = (uint16_t)max_ret;
+
+  return true;
+}
+
+// Parses "xx:xx:xx:xx:xx:xx"
+bool ParseEthAddr(const std::string &str, ether_addr &addr) {
+  if (str.length() != 3*ETHER_ADDR_LEN - 1) {
+    return false;
+  }
+  for (uint8_t i = 0; i < ETHER_ADDR_LEN; ++i) {
+    const char *byte_s = str.c_str() + 3*i;
+    if (!isxdigit(byte_s[0]) || !isxdigit(byte_s[1]) || (i < ETHER_ADDR_LEN-1 && byte_s[2] != ':')) {
+      return false;
+    }
+    addr.addr_bytes[i] = (uint8_t)strtoul(std::string(byte_s, 2).c_str(), nullptr, 16);
+  }
+
+  return true;
+}
+
+const void *ReadMbufData(const rte_mbuf *m, const uint32_t offset, const uint32_t len, void *buf) {
+  // Find segment with the first byte
+  uint32_t seg_offset = offset;
+  const rte_mbuf *seg = m;
+  while (seg && seg_offset >= seg->data_len) {
+    seg_offset -= seg->data_len;
+    seg = seg->next;
+  }
+  if (!seg) {
+    return nullptr;
+  }
+
+  // Data is contiguous - copy isn't required
+  if (seg_offset + len <= seg->data_len) {
+    return rte_pktmbuf_mtod_offset(seg, const char *, seg_offset);
+  }
+
+  // Linearize data into the buffer
+  char *dst = (char *)buf;
+  uint32_t remain = len;
+  while (seg && remain > 0) {
+    const uint32_t copy_len = RTE_MIN(remain, (uint32_t)(seg->data_len - seg_offset));
+    rte_memcpy(dst, rte_pktmbuf_mtod_offset(seg, const char *, seg_offset), copy_len);
+    dst += copy_len;
+    remain -= copy_len;
+    seg_offset = 0;
+    seg = seg->next;
+  }
+
+  return remain == 0 ? buf : nullptr;
+}
+
+const char *GetPayload(const rte_mbuf *m, char *buf, uint16_t &payload_len) {
+  const uint16_t headers_len = m->outer_l2_len + m->outer_l3_len + m->l2_len + m->l3_len + m->l4_len;
+  if (headers_len >= m->pkt_len) {
+    payload_len = 0;
+    return nullptr;
+  }
+
+  // Payload (or enough part of it) is located in the first segment
+  const uint32_t total_len = m->pkt_len - headers_len;
+  if (headers_len < m->data_len) {
+    const uint16_t seg_payload_len = m->data_len - headers_len;
+    if (seg_payload_len == total_len || seg_payload_len >= kMAX_PAYLOAD_INSPECT_LEN) {
+      payload_len = seg_payload_len;
+      return rte_pktmbuf_mtod_offset(m, const char *, headers_len);
+    }
+  }
+
+  // Only first bytes of the segmented payload are linearized
+  payload_len = RTE_MIN(total_len, (uint32_t)kMAX_PAYLOAD_INSPECT_LEN);
+  const char *payload = (const char *)ReadMbufData(m, headers_len, payload_len, buf);
+  if (!payload) {
+    payload_len = 0;
+  }
+
+  return payload;
+}
+
+// Parses IPv6 header with extension headers which starts at offset.
+// ip_proto is the upper-layer protocol, frag_offset is the offset of fragment header (0 if there isn't one).
+bool ParseIpv6Headers(const char *data, const uint16_t data_len, const uint16_t offset,
+                      uint16_t &l3_len, uint8_t &ip_proto, uint16_t &frag_offset) {
+  if (offset + sizeof(ipv6_hdr) > data_len) {
+    DLOG(WARNING) << "Packet is truncated";
+    return false;
+  }
+  l3_len = sizeof(ipv6_hdr);
+  ip_proto = ((const ipv6_hdr *)(data + offset))->proto;
+  frag_offset = 0;
+
+  // Extension headers chain (bounded)
+  for (uint8_t i = 0; ; ++i) {
+    const uint16_t pos = offset + l3_len;
+    uint16_t ext_len;
+    bool last = false;
+    switch (ip_proto) {
+      case IPPROTO_HOPOPTS:
+      case IPPROTO_ROUTING:
+      case IPPROTO_DSTOPTS: {
+        if (pos + 2 > data_len) {
+          DLOG(WARNING) << "Packet is truncated";
+          return false;
+        }
+        ext_len = 8*(*(const uint8_t *)(data + pos + 1) + 1);
+        break;
+      }
+      case IPPROTO_AH: {
+        if (pos + 2 > data_len) {
+          DLOG(WARNING) << "Packet is truncated";
+          return false;
+        }
+        ext_len = 4*(*(const uint8_t *)(data + pos + 1) + 2);
+        break;
+      }
+      case IPPROTO_FRAGMENT: {
+        if (pos + kIPV6_FRAG_HDR_LEN > data_len) {
+          DLOG(WARNING) << "Packet is truncated";
+          return false;
+        }
+        ext_len = kIPV6_FRAG_HDR_LEN;
+        frag_offset = pos;
+        // Headers of non-first fragment end here, the rest is a part of fragmented data
+        last = (rte_be_to_cpu_16(*(const uint16_t *)(data + pos + 2)) & kIPV6_FRAG_OFFSET_MASK) != 0;
+        break;
+      }
+      default: {
+        return true;
+      }
+    }
+    if (i == kMAX_IPV6_EXT_HDRS) {
+      DLOG(WARNING) << "Too many IPv6 extension headers";
+      return false;
+    }
+    if (pos + ext_len > data_len) {
+      DLOG(WARNING) << "Packet is truncated";
+      return false;
+    }
+    ip_proto = *(const uint8_t *)(data + pos);
+    l3_len += ext_len;
+    if (last) {
+      return true;
+    }
+  }
+}
+
 namespace packet_modifier{
-bool PreparePacket(rte_mbuf *m) {
-  char *pkt_data = rte_ctrlmbuf_data(m);
-  uint16_t *eth_type = (uint16_t *)(pkt_data + 2*ETHER_ADDR_LEN);
-  m->l2_len = 2*ETHER_ADDR_LEN;
+// Fragmentation of IP packet
+enum fragment_type: uint8_t {
+  FRAG_NONE,
+  FRAG_FIRST,
+  FRAG_NON_FIRST,
+};
 
+// Result of packet preparation based on packet type reported by NIC
+enum ptype_status: uint8_t {
+  PTYPE_OK,
+  PTYPE_DROP,
+  PTYPE_FALLBACK,
+};
+
+static inline bool IsTunnelPort(const uint16_t port) {
+  return port == rte_cpu_to_be_16(kVXLAN_PORT) || port == rte_cpu_to_be_16(kGTPU_PORT);
+}
+
+// Ethertype is in network byte order
+static inline bool IsMplsEthType(const uint16_t eth_type) {
+  return eth_type == rte_cpu_to_be_16(ETHER_TYPE_MPLS) || eth_type == rte_cpu_to_be_16(ETHER_TYPE_MPLS_MULTICAST);
+}
+
+static ptype_status PreparePacketByPtype(rte_mbuf *m, const uint8_t flags) {
+  const uint32_t ptype = m->packet_type;
+
+  // Packets which are not TCP/UDP are dropped without touching packet data
+  const uint32_t l4_type = ptype & RTE_PTYPE_L4_MASK;
+  switch (l4_type) {
+    case RTE_PTYPE_L4_TCP:
+    case RTE_PTYPE_L4_UDP: {
+      break;
+    }
+    case RTE_PTYPE_L4_NONFRAG: {
+      // It may be GRE
+      return (flags & PREPARE_TUNNELS) ? PTYPE_FALLBACK : PTYPE_DROP;
+    }
+    case RTE_PTYPE_L4_SCTP:
+    case RTE_PTYPE_L4_ICMP: {
+      return PTYPE_DROP;
+    }
+    default: {
+      return PTYPE_FALLBACK;
+    }
+  }
+
+  uint16_t l2_len;
+  switch (ptype & RTE_PTYPE_L2_MASK) {
+    case RTE_PTYPE_L2_ETHER: {
+      // Some NICs don't distinguish VLAN, so ethertype is checked
+      const uint16_t *eth_type = rte_pktmbuf_mtod_offset(m, const uint16_t *, 2*ETHER_ADDR_LEN);
+      if (*eth_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+          *eth_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN_8021AD) || IsMplsEthType(*eth_type)) {
+        return PTYPE_FALLBACK;
+      }
+      l2_len = sizeof(ether_hdr);
+      break;
+    }
+    case RTE_PTYPE_L2_ETHER_VLAN: {
+      l2_len = sizeof(ether_hdr) + sizeof(vlan_hdr);
+      break;
+    }
+    case RTE_PTYPE_L2_ETHER_QINQ: {
+      l2_len = sizeof(ether_hdr) + 2*sizeof(vlan_hdr);
+      break;
+    }
+    default: {
+      return PTYPE_FALLBACK;
+    }
+  }
+
+  uint16_t l3_len;
+  switch (ptype & RTE_PTYPE_L3_MASK) {
+    case RTE_PTYPE_L3_IPV4: {
+      l3_len = sizeof(ipv4_hdr);
+      break;
+    }
+    case RTE_PTYPE_L3_IPV4_EXT:
+    case RTE_PTYPE_L3_IPV4_EXT_UNKNOWN: {
+      if (l2_len + sizeof(ipv4_hdr) > m->data_len) {
+        return PTYPE_FALLBACK;
+      }
+      const ipv4_hdr *ipv4 = rte_pktmbuf_mtod_offset(m, const ipv4_hdr *, l2_len);
+      l3_len = 4*(ipv4->version_ihl & 0x0F);
+      break;
+    }
+    case RTE_PTYPE_L3_IPV6: {
+      l3_len = sizeof(ipv6_hdr);
+      break;
+    }
+    default: {
+      return PTYPE_FALLBACK;
+    }
+  }
+
+  uint16_t l4_len;
+  if (l4_type == RTE_PTYPE_L4_TCP) {
+    if (l2_len + l3_len + sizeof(tcp_hdr) > m->data_len) {
+      return PTYPE_FALLBACK;
+    }
+    const tcp_hdr *tcp = rte_pktmbuf_mtod_offset(m, const tcp_hdr *, l2_len + l3_len);
+    l4_len = 4*((tcp->data_off & 0xF0) >> 4);
+  }
+  else {
+    if (flags & PREPARE_TUNNELS) {
+      if (l2_len + l3_len + sizeof(udp_hdr) > m->data_len) {
+        return PTYPE_FALLBACK;
+      }
+      const udp_hdr *udp = rte_pktmbuf_mtod_offset(m, const udp_hdr *, l2_len + l3_len);
+      if (IsTunnelPort(udp->dst_port)) {
+        return PTYPE_FALLBACK;
+      }
+    }
+    l4_len = sizeof(udp_hdr);
+  }
+
+  if ((uint32_t)(l2_len + l3_len + l4_len) > m->pkt_len) {
+    return PTYPE_DROP;
+  }
+
+  m->outer_l2_len = 0;
+  m->outer_l3_len = 0;
+  m->l2_len = l2_len;
+  m->l3_len = l3_len;
+  m->l4_len = l4_len;
+
+  return PTYPE_OK;
+}
+
+// Parses Ethernet header with VLAN tags and MPLS labels which starts at offset
+static bool ParseL2(const char *data, const uint16_t data_len, const uint16_t offset,
+                    uint16_t &l2_len, uint16_t &eth_type) {
   // Skip VLAN tags
-  while (*eth_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
-         *eth_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN_8021AD)) {
-    eth_type += 2;
-    m->l2_len += 4;
+  uint16_t pos = offset + 2*ETHER_ADDR_LEN;
+  uint8_t vlan_tags = 0;
+  while (pos + sizeof(uint16_t) <= data_len &&
+         (*(const uint16_t *)(data + pos) == rte_cpu_to_be_16(ETHER_TYPE_VLAN) ||
+          *(const uint16_t *)(data + pos) == rte_cpu_to_be_16(ETHER_TYPE_VLAN_8021AD))) {
+    if (++vlan_tags > kMAX_VLAN_TAGS) {
+      DLOG(WARNING) << "Too many VLAN tags";
+      return false;
+    }
+    pos += 4;
+  }
+  if (pos + sizeof(uint16_t) > data_len) {
+    DLOG(WARNING) << "Packet is truncated";
+    return false;
   }
-  m->l2_len += 2;
 
+  eth_type = rte_be_to_cpu_16(*(const uint16_t *)(data + pos));
+  pos += sizeof(uint16_t);
+
+  // Skip MPLS labels, payload type is guessed by IP version
+  if (IsMplsEthType(rte_cpu_to_be_16(eth_type))) {
+    uint8_t mpls_labels = 0;
+    uint32_t label;
+    do {
+      if (++mpls_labels > kMAX_MPLS_LABELS) {
+        DLOG(WARNING) << "Too many MPLS labels";
+        return false;
+      }
+      if (pos + sizeof(label) + 1 > data_len) {
+        DLOG(WARNING) << "Packet is truncated";
+        return false;
+      }
+      label = rte_be_to_cpu_32(*(const uint32_t *)(data + pos));
+      pos += sizeof(label);
+    } while (!(label & kMPLS_BOS_FLAG));
+    switch (*(const uint8_t *)(data + pos) >> 4) {
+      case 4: {
+        eth_type = ETHER_TYPE_IPv4;
+        break;
+      }
+      case 6: {
+        eth_type = ETHER_TYPE_IPv6;
+        break;
+      }
+      default: {
+        DLOG(WARNING) << "MPLS payload is not IP";
+        return false;
+      }
+    }
+  }
+  l2_len = pos - offset;
+
+  return true;
+}
+
+// Parses IP header which starts at offset
+static bool ParseL3(const char *data, const uint16_t data_len, const uint16_t offset, const uint16_t eth_type,
+                    uint16_t &l3_len, uint8_t &ip_proto, uint32_t &l3_ptype, fragment_type &fragment) {
   // If it's not IP packet - skip it
-  uint8_t ip_proto = 0;
-  switch (rte_cpu_to_be_16(*eth_type)) {
+  switch (eth_type) {
     case ETHER_TYPE_IPv4: {
-      ipv4_hdr *ipv4 = (ipv4_hdr *)(eth_type + 1);
-      m->l3_len = 4*(ipv4->version_ihl & 0x0F);
+      if (offset + sizeof(ipv4_hdr) > data_len) {
+        DLOG(WARNING) << "Packet is truncated";
+        return false;
+      }
+      const ipv4_hdr *ipv4 = (const ipv4_hdr *)(data + offset);
+      l3_len = 4*(ipv4->version_ihl & 0x0F);
+      l3_ptype = l3_len > sizeof(ipv4_hdr) ? RTE_PTYPE_L3_IPV4_EXT : RTE_PTYPE_L3_IPV4;
       ip_proto = ipv4->next_proto_id;
+      const uint16_t frag_data = rte_be_to_cpu_16(ipv4->fragment_offset);
+      if (frag_data & IPV4_HDR_OFFSET_MASK) {
+        fragment = FRAG_NON_FIRST;
+      }
+      else {
+        fragment = (frag_data & IPV4_HDR_MF_FLAG) ? FRAG_FIRST : FRAG_NONE;
+      }
       break;
     }
     case ETHER_TYPE_IPv6: {
-      m->l3_len = sizeof(ipv6_hdr); // always 40 bytes
-      ip_proto = ((ipv6_hdr *)(eth_type + 1))->proto;
+      uint16_t frag_offset;
+      if (!ParseIpv6Headers(data, data_len, offset, l3_len, ip_proto, frag_offset)) {
+        return false;
+      }
+      l3_ptype = l3_len > sizeof(ipv6_hdr) ? RTE_PTYPE_L3_IPV6_EXT : RTE_PTYPE_L3_IPV6;
+      fragment = FRAG_NONE;
+      if (frag_offset) {
+        const uint16_t frag_data = rte_be_to_cpu_16(*(const uint16_t *)(data + frag_offset + 2));
+        if (frag_data & kIPV6_FRAG_OFFSET_MASK) {
+          fragment = FRAG_NON_FIRST;
+        }
+        else if (frag_data & kIPV6_FRAG_MF_FLAG) {
+          fragment = FRAG_FIRST;
+        }
+      }
       break;
     }
     default: {
@@ -56,15 +478,25 @@ bool PreparePacket(rte_mbuf *m) {
     }
   }
 
+  return true;
+}
+
+// Parses TCP/UDP header which starts at offset
+static bool ParseL4(const char *data, const uint16_t data_len, const uint16_t offset, const uint8_t ip_proto,
+                    uint16_t &l4_len) {
   // If it's not TCP or UDP packet - skip it
   switch (ip_proto) {
     case IPPROTO_TCP: {
-      tcp_hdr *tcp = rte_pktmbuf_mtod_offset(m, tcp_hdr *, m->l2_len + m->l3_len);
-      m->l4_len = 4*((tcp->data_off & 0xF0) >> 4);
+      if (offset + sizeof(tcp_hdr) > data_len) {
+        DLOG(WARNING) << "Packet is truncated";
+        return false;
+      }
+      const tcp_hdr *tcp = (const tcp_hdr *)(data + offset);
+      l4_len = 4*((tcp->data_off & 0xF0) >> 4);
       break;
     }
     case IPPROTO_UDP: {
-      m->l4_len = sizeof(udp_hdr); // always 8 bytes
+      l4_len = sizeof(udp_hdr); // always 8 bytes
       break;
     }
     default: {
@@ -76,6 +508,222 @@ bool PreparePacket(rte_mbuf *m) {
   return true;
 }
 
+// Recognizes tunnel header which starts at offset (right after outer IP header).
+// Returns tunnel packet type or 0 if packet isn't tunneled.
+// tunnel_len includes outer UDP header, inner_eth_type is ETHER_TYPE_TEB for inner Ethernet.
+static uint32_t ParseTunnel(const char *data, const uint16_t data_len, const uint16_t offset, const uint8_t ip_proto,
+                            uint16_t &tunnel_len, uint16_t &inner_eth_type) {
+  switch (ip_proto) {
+    case IPPROTO_GRE: {
+      if (offset + kGRE_HDR_LEN > data_len) {
+        return 0;
+      }
+      const uint16_t gre_flags = rte_be_to_cpu_16(*(const uint16_t *)(data + offset));
+      // Only GRE version 0 without routing is supported
+      if (gre_flags & (kGRE_ROUTING_FLAG | kGRE_VERSION_MASK)) {
+        return 0;
+      }
+      tunnel_len = kGRE_HDR_LEN;
+      tunnel_len += (gre_flags & kGRE_CHECKSUM_FLAG) ? 4 : 0;
+      tunnel_len += (gre_flags & kGRE_KEY_FLAG) ? 4 : 0;
+      tunnel_len += (gre_flags & kGRE_SEQUENCE_FLAG) ? 4 : 0;
+      inner_eth_type = rte_be_to_cpu_16(*(const uint16_t *)(data + offset + 2));
+      if (inner_eth_type != ETHER_TYPE_IPv4 && inner_eth_type != ETHER_TYPE_IPv6 &&
+          inner_eth_type != ETHER_TYPE_TEB) {
+        return 0;
+      }
+      return RTE_PTYPE_TUNNEL_GRE;
+    }
+    case IPPROTO_UDP: {
+      if (offset + sizeof(udp_hdr) > data_len) {
+        return 0;
+      }
+      const udp_hdr *udp = (const udp_hdr *)(data + offset);
+      const uint16_t pos = offset + sizeof(udp_hdr);
+      if (udp->dst_port == rte_cpu_to_be_16(kVXLAN_PORT)) {
+        // Valid VNI flag is required
+        if (pos + kVXLAN_HDR_LEN > data_len || !(*(const uint8_t *)(data + pos) & kVXLAN_VNI_FLAG)) {
+          return 0;
+        }
+        tunnel_len = sizeof(udp_hdr) + kVXLAN_HDR_LEN;
+        inner_eth_type = ETHER_TYPE_TEB;
+        return RTE_PTYPE_TUNNEL_VXLAN;
+      }
+      if (udp->dst_port == rte_cpu_to_be_16(kGTPU_PORT)) {
+        if (pos + kGTPU_HDR_LEN > data_len) {
+          return 0;
+        }
+        const uint8_t gtp_flags = *(const uint8_t *)(data + pos);
+        const uint8_t gtp_type = *(const uint8_t *)(data + pos + 1);
+        // Only GTPv1 G-PDU carries user packets
+        if ((gtp_flags & kGTPU_VERSION_MASK) != kGTPU_VERSION_1 || gtp_type != kGTPU_TYPE_GPDU) {
+          return 0;
+        }
+        uint16_t gtp_len = kGTPU_HDR_LEN;
+        if (gtp_flags & kGTPU_OPT_FLAGS) {
+          // Sequence number, N-PDU number and next extension header type
+          gtp_len += 4;
+          if (pos + gtp_len > data_len) {
+            return 0;
+          }
+          uint8_t next_ext = *(const uint8_t *)(data + pos + gtp_len - 1);
+          // Extension headers chain (bounded)
+          for (uint8_t i = 0; next_ext != 0; ++i) {
+            if (i == kGTPU_MAX_EXT_HDRS || pos + gtp_len + 1 > data_len) {
+              return 0;
+            }
+            const uint16_t ext_len = 4*(*(const uint8_t *)(data + pos + gtp_len));
+            if (ext_len == 0 || pos + gtp_len + ext_len > data_len) {
+              return 0;
+            }
+            gtp_len += ext_len;
+            next_ext = *(const uint8_t *)(data + pos + gtp_len - 1);
+          }
+        }
+        // Inner IP version
+        if (pos + gtp_len + 1 > data_len) {
+          return 0;
+        }
+        switch (*(const uint8_t *)(data + pos + gtp_len) >> 4) {
+          case 4: {
+            inner_eth_type = ETHER_TYPE_IPv4;
+            break;
+          }
+          case 6: {
+            inner_eth_type = ETHER_TYPE_IPv6;
+            break;
+          }
+          default: {
+            return 0;
+          }
+        }
+        tunnel_len = sizeof(udp_hdr) + gtp_len;
+        return RTE_PTYPE_TUNNEL_GTPU;
+      }
+      return 0;
+    }
+    default: {
+      return 0;
+    }
+  }
+}
+
+bool PreparePacket(rte_mbuf *m, const uint8_t flags) {
+  if (flags & PREPARE_PTYPE) {
+    switch (PreparePacketByPtype(m, flags)) {
+      case PTYPE_OK: {
+        return true;
+      }
+      case PTYPE_DROP: {
+        DLOG(WARNING) << "Packet is not TCP/UDP (by packet type) - not supported";
+        return false;
+      }
+      case PTYPE_FALLBACK:
+      default: {
+        break;
+      }
+    }
+  }
+
+  // Headers are read through a window which is linearized only for segmented packets
+  char buf[kMAX_HEADERS_LEN];
+  const uint16_t data_len = RTE_MIN(m->pkt_len, (uint32_t)kMAX_HEADERS_LEN);
+  const char *pkt_data = (const char *)ReadMbufData(m, 0, data_len, buf);
+  if (!pkt_data) {
+    DLOG(WARNING) << "Packet is truncated";
+    return false;
+  }
+
+  uint16_t l2_len, l3_len, l4_len = 0, eth_type;
+  uint8_t ip_proto;
+  uint32_t l3_ptype;
+  fragment_type fragment;
+  if (!ParseL2(pkt_data, data_len, 0, l2_len, eth_type) ||
+      !ParseL3(pkt_data, data_len, l2_len, eth_type, l3_len, ip_proto, l3_ptype, fragment)) {
+    return false;
+  }
+
+  uint16_t outer_l2_len = 0, outer_l3_len = 0;
+  uint32_t tunnel_ptype = 0;
+  // Tunnels are not looked for in fragmented packets
+  if ((flags & PREPARE_TUNNELS) && fragment == FRAG_NONE) {
+    // Inner headers are parsed for tunneled packets:
+    // l2_len covers outer UDP, tunnel header and inner Ethernet (as for DPDK tunnel offloads)
+    uint16_t tunnel_len, inner_eth_type;
+    tunnel_ptype = ParseTunnel(pkt_data, data_len, l2_len + l3_len, ip_proto, tunnel_len, inner_eth_type);
+    if (tunnel_ptype) {
+      outer_l2_len = l2_len;
+      outer_l3_len = l3_len;
+      const uint16_t offset = outer_l2_len + outer_l3_len + tunnel_len;
+      uint16_t inner_l2_len = 0;
+      eth_type = inner_eth_type;
+      if (inner_eth_type == ETHER_TYPE_TEB && !ParseL2(pkt_data, data_len, offset, inner_l2_len, eth_type)) {
+        return false;
+      }
+      l2_len = tunnel_len + inner_l2_len;
+      if (l2_len > kMAX_TUNNEL_L2_LEN ||
+          !ParseL3(pkt_data, data_len, offset + inner_l2_len, eth_type, l3_len, ip_proto, l3_ptype, fragment)) {
+        return false;
+      }
+    }
+  }
+
+  // Non-first fragments don't have L4 header
+  uint32_t l4_ptype = RTE_PTYPE_L4_FRAG;
+  if (fragment != FRAG_NON_FIRST) {
+    if (!ParseL4(pkt_data, data_len, outer_l2_len + outer_l3_len + l2_len + l3_len, ip_proto, l4_len)) {
+      return false;
+    }
+    if (fragment == FRAG_NONE) {
+      l4_ptype = ip_proto == IPPROTO_TCP ? RTE_PTYPE_L4_TCP : RTE_PTYPE_L4_UDP;
+    }
+  }
+  else if (ip_proto != IPPROTO_TCP && ip_proto != IPPROTO_UDP) {
+    DLOG(WARNING) << "Packet is not TCP/UDP - not supported";
+    return false;
+  }
+  m->packet_type = (m->packet_type & ~(RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK | RTE_PTYPE_TUNNEL_MASK)) |
+                   l3_ptype | l4_ptype | tunnel_ptype;
+
+  if ((uint32_t)(outer_l2_len + outer_l3_len + l2_len + l3_len + l4_len) > m->pkt_len) {
+    DLOG(WARNING) << "Packet is truncated";
+    return false;
+  }
+
+  m->outer_l2_len = outer_l2_len;
+  m->outer_l3_len = outer_l3_len;
+  m->l2_len = l2_len;
+  m->l3_len = l3_len;
+  m->l4_len = l4_len;
+
+  return true;
+}
+
+// Push and pop change outer L2 header, so its length is kept valid for the next actions
+static inline void AdjustL2Len(rte_mbuf *m, const int16_t delta) {
+  if (m->outer_l2_len) {
+    m->outer_l2_len += delta;
+  }
+  else {
+    m->l2_len += delta;
+  }
+}
+
+// Returns offset of ethertype which follows VLAN tags (MPLS labels go after it)
+static inline uint16_t GetEthTypeOffset(const rte_mbuf *m) {
+  const uint16_t l2_len = m->outer_l2_len ? m->outer_l2_len : m->l2_len;
+  uint16_t offset = 2*ETHER_ADDR_LEN;
+  while (offset + sizeof(vlan_hdr) + sizeof(uint16_t) <= l2_len) {
+    const uint16_t eth_type = *rte_pktmbuf_mtod_offset(m, const uint16_t *, offset);
+    if (eth_type != rte_cpu_to_be_16(ETHER_TYPE_VLAN) && eth_type != rte_cpu_to_be_16(ETHER_TYPE_VLAN_8021AD)) {
+      break;
+    }
+    offset += sizeof(vlan_hdr);
+  }
+
+  return offset;
+}
+
 void ExecutePushVlan(rte_mbuf *m, const uint32_t vlan_tag) {
   if (rte_vlan_insert(&m) != 0) {
     LOG(WARNING) << "Can't insert vlan";
@@ -85,9 +733,18 @@ void ExecutePushVlan(rte_mbuf *m, const uint32_t vlan_tag) {
   constexpr uint8_t mac_addr_len = 6;
   char *dst_data = rte_pktmbuf_mtod_offset(m, char *, mac_addr_len*2);
   rte_memcpy(dst_data, &vlan_tag, sizeof(vlan_tag));
+  AdjustL2Len(m, sizeof(vlan_tag));
 }
 
 void ExecutePushMpls(rte_mbuf *m, const uint32_t mpls_label) {
+  // Label is inserted on top of label stack (after VLAN tags of outer L2 header for tunneled packets)
+  const uint16_t l2_len = m->outer_l2_len ? m->outer_l2_len : m->l2_len;
+  if (m->data_len < l2_len) {
+    LOG(WARNING) << "Can't insert mpls (L2 header is segmented)";
+    return;
+  }
+  const uint16_t eth_type_offset = GetEthTypeOffset(m);
+
   char *src_data = rte_pktmbuf_mtod(m, char *);
   char *dst_data = (char *)rte_pktmbuf_prepend(m, sizeof(mpls_label));
   if (!dst_data) {
@@ -95,9 +752,169 @@ void ExecutePushMpls(rte_mbuf *m, const uint32_t mpls_label) {
     return;
   }
 
-  memmove(dst_data, src_data, m->l2_len);
-  rte_memcpy(dst_data+m->l2_len, &mpls_label, sizeof(mpls_label));
-  const uint16_t mpls_ethertype = rte_cpu_to_be_16(0x8847);
-  rte_memcpy(dst_data+m->l2_len-2, &mpls_ethertype, 2);
+  memmove(dst_data, src_data, eth_type_offset + 2);
+  rte_memcpy(dst_data+eth_type_offset+2, &mpls_label, sizeof(mpls_label));
+  const uint16_t mpls_ethertype = rte_cpu_to_be_16(ETHER_TYPE_MPLS);
+  rte_memcpy(dst_data+eth_type_offset, &mpls_ethertype, 2);
+  AdjustL2Len(m, sizeof(mpls_label));
+}
+
+// Outer VLAN tag is removed, MAC addresses are moved in place of it
+void ExecutePopVlan(rte_mbuf *m) {
+  const uint16_t l2_len = m->outer_l2_len ? m->outer_l2_len : m->l2_len;
+  if (m->data_len < l2_len) {
+    LOG(WARNING) << "Can't remove vlan (L2 header is segmented)";
+    return;
+  }
+  if (GetEthTypeOffset(m) == 2*ETHER_ADDR_LEN) {
+    return;
+  }
+
+  char *src_data = rte_pktmbuf_mtod(m, char *);
+  char *dst_data = rte_pktmbuf_adj(m, sizeof(vlan_hdr));
+  memmove(dst_data, src_data, 2*ETHER_ADDR_LEN);
+  AdjustL2Len(m, -(int16_t)sizeof(vlan_hdr));
+}
+
+// Top MPLS label is removed, ethertype of the last label's payload is taken by IP version
+void ExecutePopMpls(rte_mbuf *m) {
+  const uint16_t l2_len = m->outer_l2_len ? m->outer_l2_len : m->l2_len;
+  if (m->data_len <= l2_len) {
+    LOG(WARNING) << "Can't remove mpls (L2 header is segmented)";
+    return;
+  }
+  const uint16_t eth_type_offset = GetEthTypeOffset(m);
+  uint16_t *eth_type = rte_pktmbuf_mtod_offset(m, uint16_t *, eth_type_offset);
+  if (!IsMplsEthType(*eth_type)) {
+    return;
+  }
+
+  const uint32_t label = rte_be_to_cpu_32(*rte_pktmbuf_mtod_offset(m, const uint32_t *, eth_type_offset + 2));
+  if (label & kMPLS_BOS_FLAG) {
+    const uint8_t version = *rte_pktmbuf_mtod_offset(m, const uint8_t *, eth_type_offset + 2 + sizeof(label)) >> 4;
+    *eth_type = rte_cpu_to_be_16(version == 6 ? ETHER_TYPE_IPv6 : ETHER_TYPE_IPv4);
+  }
+  char *src_data = rte_pktmbuf_mtod(m, char *);
+  char *dst_data = rte_pktmbuf_adj(m, sizeof(label));
+  memmove(dst_data, src_data, eth_type_offset + 2);
+  AdjustL2Len(m, -(int16_t)sizeof(label));
+}
+
+// Only length fields are changed, so it's safe for clones
+void ExecuteTruncate(rte_mbuf *m, const uint32_t len) {
+  if (m->pkt_len <= len) {
+    return;
+  }
+
+  rte_mbuf *seg = m;
+  uint32_t remain = len;
+  uint8_t nb_segs = 1;
+  while (seg->data_len < remain) {
+    remain -= seg->data_len;
+    seg = seg->next;
+    ++nb_segs;
+  }
+  seg->data_len = remain;
+  rte_pktmbuf_free(seg->next);
+  seg->next = nullptr;
+  m->nb_segs = nb_segs;
+  m->pkt_len = len;
+}
+
+// Checksum is updated incrementally (RFC 1624), copies of packet don't inherit tx offload flags
+static inline uint16_t UpdateChecksum(const uint16_t cksum, const uint16_t old_value, const uint16_t new_value) {
+  uint32_t sum = (uint16_t)~cksum + (uint32_t)(uint16_t)~old_value + new_value;
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+
+  return (uint16_t)~sum;
+}
+
+// Header rewrites are applied to outer IP header of tunneled packets
+static void *GetIpHeader(rte_mbuf *m, uint8_t &version) {
+  const uint16_t l2_len = m->outer_l2_len ? m->outer_l2_len : m->l2_len;
+  if ((uint32_t)l2_len + sizeof(ipv4_hdr) > m->data_len) {
+    return nullptr;
+  }
+  uint8_t *ip = rte_pktmbuf_mtod_offset(m, uint8_t *, l2_len);
+  version = *ip >> 4;
+  if (version == 6 && (uint32_t)l2_len + sizeof(ipv6_hdr) > m->data_len) {
+    return nullptr;
+  }
+
+  return (version == 4 || version == 6) ? ip : nullptr;
+}
+
+void ExecuteSetDscp(rte_mbuf *m, const uint8_t dscp) {
+  uint8_t version;
+  void *ip = GetIpHeader(m, version);
+  if (!ip) {
+    LOG(WARNING) << "Can't set dscp (IP header is segmented)";
+    return;
+  }
+
+  // ECN bits are kept
+  if (version == 4) {
+    ipv4_hdr *ipv4 = (ipv4_hdr *)ip;
+    uint16_t old_word, new_word;
+    memcpy(&old_word, &ipv4->version_ihl, sizeof(old_word));
+    ipv4->type_of_service = (dscp << 2) | (ipv4->type_of_service & 0x03);
+    memcpy(&new_word, &ipv4->version_ihl, sizeof(new_word));
+    ipv4->hdr_checksum = UpdateChecksum(ipv4->hdr_checksum, old_word, new_word);
+  }
+  else {
+    ipv6_hdr *ipv6 = (ipv6_hdr *)ip;
+    const uint32_t vtc_flow = rte_be_to_cpu_32(ipv6->vtc_flow);
+    ipv6->vtc_flow = rte_cpu_to_be_32((vtc_flow & ~(0x3fU << 22)) | ((uint32_t)dscp << 22));
+  }
+}
+
+// Returns false if TTL (hop limit) is expired, such packet has to be dropped
+bool ExecuteDecTtl(rte_mbuf *m) {
+  uint8_t version;
+  void *ip = GetIpHeader(m, version);
+  if (!ip) {
+    LOG(WARNING) << "Can't decrement ttl (IP header is segmented)";
+    return true;
+  }
+
+  if (version == 4) {
+    ipv4_hdr *ipv4 = (ipv4_hdr *)ip;
+    if (ipv4->time_to_live <= 1) {
+      return false;
+    }
+    uint16_t old_word, new_word;
+    memcpy(&old_word, &ipv4->time_to_live, sizeof(old_word));
+    --ipv4->time_to_live;
+    memcpy(&new_word, &ipv4->time_to_live, sizeof(new_word));
+    ipv4->hdr_checksum = UpdateChecksum(ipv4->hdr_checksum, old_word, new_word);
+  }
+  else {
+    ipv6_hdr *ipv6 = (ipv6_hdr *)ip;
+    if (ipv6->hop_limits <= 1) {
+      return false;
+    }
+    --ipv6->hop_limits;
+  }
+
+  return true;
+}
+
+void ExecuteSetEthDst(rte_mbuf *m, const ether_addr &addr) {
+  if (m->data_len < sizeof(ether_hdr)) {
+    LOG(WARNING) << "Can't set destination mac (L2 header is segmented)";
+    return;
+  }
+
+  ether_addr_copy(&addr, &rte_pktmbuf_mtod(m, ether_hdr *)->d_addr);
+}
+
+void ExecuteSetEthSrc(rte_mbuf *m, const ether_addr &addr) {
+  if (m->data_len < sizeof(ether_hdr)) {
+    LOG(WARNING) << "Can't set source mac (L2 header is segmented)";
+    return;
+  }
+
+  ether_addr_copy(&addr, &rte_pktmbuf_mtod(m, ether_hdr *)->s_addr);
 }
 }
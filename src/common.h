@@ -4,8 +4,19 @@
 #include <unordered_map>
 #include <rte_config.h>
 #include <rte_mbuf.h>
+#include <rte_ether.h>
 
 #define CACHE_LINE_SIZE 64
+// GTP-U packet type isn't defined by older DPDK versions
+#ifndef RTE_PTYPE_TUNNEL_GTPU
+#define RTE_PTYPE_TUNNEL_GTPU 0x00008000
+#endif
+
+// Packet headers are parsed in a window of this size
+static constexpr uint16_t kMAX_HEADERS_LEN = 256;
+// Search methods look at most at this number of payload bytes
+// if the payload is not contiguous
+static constexpr uint16_t kMAX_PAYLOAD_INSPECT_LEN = 256;
 
 enum protocol_type: uint8_t {
   HTTP,
@@ -28,6 +39,17 @@ enum action_type: uint8_t {
   PUSH_VLAN,
   PUSH_MPLS,
   OUTPUT,
+  METER,
+  CAPTURE,
+  SAMPLE,
+  MIRROR,
+  SET_DSCP,
+  DEC_TTL,
+  SET_ETH_DST,
+  SET_ETH_SRC,
+  POP_VLAN,
+  POP_MPLS,
+  OUTPUT_GROUP,
 };
 
 static std::unordered_map<uint8_t, uint8_t> action_priority = {
@@ -35,14 +57,55 @@ static std::unordered_map<uint8_t, uint8_t> action_priority = {
   {PUSH_VLAN, 1},
   {PUSH_MPLS, 1},
   {OUTPUT, 2},
+  {METER, 0},
+  {CAPTURE, 3},
+  {SAMPLE, 3},
+  {MIRROR, 3},
+  {SET_DSCP, 1},
+  {DEC_TTL, 1},
+  {SET_ETH_DST, 1},
+  {SET_ETH_SRC, 1},
+  {POP_VLAN, 1},
+  {POP_MPLS, 1},
+  {OUTPUT_GROUP, 2},
+};
+
+// Flags of packet preparation
+enum prepare_flags: uint8_t {
+  PREPARE_PTYPE = 0x01,   // use packet type reported by NIC
+  PREPARE_TUNNELS = 0x02, // parse inner headers of GRE/VXLAN/GTP-U packets
 };
 
+const char *GetProtocolName(const protocol_type);
 bool ParseInt(const std::string &, unsigned long &);
+bool ParseIpv4Prefix(const std::string &, uint32_t &, uint8_t &);
+bool ParseRange(const std::string &, uint16_t &, uint16_t &);
+bool ParseEthAddr(const std::string &, ether_addr &);
+const void *ReadMbufData(const rte_mbuf *, const uint32_t, const uint32_t, void *);
+const char *GetPayload(const rte_mbuf *, char *, uint16_t &);
+bool ParseIpv6Headers(const char *, const uint16_t, const uint16_t, uint16_t &, uint8_t &, uint16_t &);
+
+// Finalizer of MurmurHash3, it spreads hashes which aren't uniform enough by themselves (e.g. RSS)
+static inline uint32_t MixHash(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
 
 namespace packet_modifier {
-  bool PreparePacket(rte_mbuf *);
+  bool PreparePacket(rte_mbuf *, const uint8_t = 0);
   void ExecutePushVlan(rte_mbuf *, const uint32_t);
   void ExecutePushMpls(rte_mbuf *, const uint32_t);
+  void ExecutePopVlan(rte_mbuf *);
+  void ExecutePopMpls(rte_mbuf *);
+  void ExecuteTruncate(rte_mbuf *, const uint32_t);
+  void ExecuteSetDscp(rte_mbuf *, const uint8_t);
+  bool ExecuteDecTtl(rte_mbuf *);
+  void ExecuteSetEthDst(rte_mbuf *, const ether_addr &);
+  void ExecuteSetEthSrc(rte_mbuf *, const ether_addr &);
 }
 
 #endif // COMMON_
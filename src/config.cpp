@@ -1,33 +1,116 @@
 #include <fstream>
 #include <algorithm>
+#include <new>
 #include <glog/logging.h>
 #include "config.h"
+#include "capture.h"
+#include "slow_path.h"
 #include <rte_byteorder.h>
 #include <rte_ethdev.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
 
 static bool inline PortIdIsValid(const unsigned long port_id) {
   return (port_id > 0 && port_id <= rte_eth_dev_count());
 }
 
-Config::Config(const std::string &file_name) : config_name_(file_name) {
+static void DeleteActions(const Actions &actions) {
+  for (auto it = actions.cbegin(); it != actions.cend(); ++it) {
+    if ((*it)->type == METER) {
+      Meter *meter = reinterpret_cast<MeterAction*>(*it)->meter;
+      meter->~Meter();
+      rte_free(meter);
+    }
+    delete *it;
+  }
 }
 
-Config::~Config() {
-  for (auto it_map = rules_.cbegin(); it_map != rules_.cend(); ++it_map) {
-    for (auto it_vec = it_map->second.cbegin(); it_vec != it_map->second.cend(); ++it_vec) {
-      delete *it_vec;
+RuleTable::RuleTable() : flow_sampling_(false) {
+}
+
+RuleTable::~RuleTable() {
+  for (auto it = actions_.cbegin(); it != actions_.cend(); ++it) {
+    DeleteActions(*it);
+  }
+}
+
+bool RuleTable::Add(const RuleConditions &conditions, const Actions &actions) {
+  if (std::find(conditions_.cbegin(), conditions_.cend(), conditions) != conditions_.cend()) {
+    return false;
+  }
+  conditions_.push_back(conditions);
+  actions_.push_back(actions);
+  for (auto action : actions) {
+    if (action->type == SAMPLE && reinterpret_cast<const SampleAction*>(action)->by_flow) {
+      flow_sampling_ = true;
     }
   }
+
+  return true;
+}
+
+bool RuleTable::Build() {
+  return classifier_.Build(conditions_);
+}
+
+void RuleTable::Classify(const uint8_t **keys, uint32_t *results, const uint32_t num) const {
+  classifier_.Classify(keys, results, num);
+}
+
+const Actions *RuleTable::GetActions(const uint32_t result) const {
+  return result ? &actions_[result-1] : nullptr;
+}
+
+size_t RuleTable::Size() const {
+  return actions_.size();
+}
+
+bool RuleTable::HasFlowSampling() const {
+  return flow_sampling_;
+}
+
+Config::Config(const std::string &file_name) : config_name_(file_name), rules_(nullptr) {
+}
+
+Config::~Config() {
+  delete rules_.load();
 }
 
 bool Config::Initialize() {
+  RuleTable *rules = Load();
+  if (!rules) {
+    return false;
+  }
+  rules_.store(rules, std::memory_order_release);
+
+  return true;
+}
+
+bool Config::Reload(Qsbr &qsbr) {
+  LOG(INFO) << "Reloading config file " << config_name_;
+  RuleTable *rules = Load();
+  if (!rules) {
+    LOG(ERROR) << "Config isn't reloaded, previous rules are kept";
+    return false;
+  }
+
+  // Old rules are deleted when all processing lcores have finished with them
+  RuleTable *old_rules = rules_.exchange(rules);
+  qsbr.Synchronize();
+  delete old_rules;
+
+  return true;
+}
+
+RuleTable *Config::Load() {
   std::ifstream config(config_name_);
 
   if (!config.is_open()) {
     LOG(ERROR) << "Can't open config file " << config_name_;
-    return false;
+    return nullptr;
   }
 
+  std::unique_ptr<RuleTable> rules(new RuleTable);
   uint16_t line_counter = 1;
   std::string rule;
   while (std::getline(config, rule)) {
@@ -35,44 +118,53 @@ bool Config::Initialize() {
     auto pos = rule.find(":");
     if (pos == std::string::npos) {
       LOG(ERROR) << "Parsing error: line " << line_counter;
-      return false;
+      return nullptr;
     }
 
     std::string left_part = rule.substr(0, pos);
     std::string right_part = rule.substr(pos+1);
 
-    uint16_t rule_key = 0;
-    if (!ParsePortAndProtocol(rule_key, left_part)) {
-      LOG(ERROR) << "Can't parse port and protocol: line " << line_counter;
-      return false;
-    }
-
-    if (rules_.find(rule_key) != rules_.end()) {
-      LOG(ERROR) << "Invalid config - overlapping: line " << line_counter;
-      return false;
+    RuleConditions conditions;
+    if (!ParseConditions(conditions, left_part)) {
+      LOG(ERROR) << "Can't parse conditions: line " << line_counter;
+      return nullptr;
     }
 
     Actions actions;
     if (!ParseActions(actions, right_part)) {
       LOG(ERROR) << "Can't parse actions: line " << line_counter;
-      return false;
+      DeleteActions(actions);
+      return nullptr;
     }
 
-    rules_[rule_key] = actions;
+    if (!rules->Add(conditions, actions)) {
+      LOG(ERROR) << "Invalid config - overlapping: line " << line_counter;
+      DeleteActions(actions);
+      return nullptr;
+    }
     ++line_counter;
   }
 
-  LOG(INFO) << "Number of rules: " << rules_.size();
+  if (!rules->Build()) {
+    return nullptr;
+  }
 
-  return true;
+  LOG(INFO) << "Number of rules: " << rules->Size();
+
+  return rules.release();
 }
 
-void Config::GetActions(const uint16_t rule_key, Actions *&actions) {
-  auto it = rules_.find(rule_key);
-  actions = it != rules_.end() ? &it->second:nullptr;
+const RuleTable *Config::GetRules() const {
+  return rules_.load(std::memory_order_acquire);
 }
 
-bool Config::ParsePortAndProtocol(uint16_t &rule_key, std::string &str) {
+bool Config::ParseConditions(RuleConditions &conditions, std::string &str) {
+  static const std::string src_prefix = "src=";
+  static const std::string dst_prefix = "dst=";
+  static const std::string sport_prefix = "sport=";
+  static const std::string dport_prefix = "dport=";
+  static const std::string vlan_prefix = "vlan=";
+
   auto pos = str.find(",");
   if (pos == std::string::npos) {
     LOG(ERROR) << "Can't parse port and protocol (delimeter not found)";
@@ -90,16 +182,63 @@ bool Config::ParsePortAndProtocol(uint16_t &rule_key, std::string &str) {
     return false;
   }
 
-  std::string protocol_s = str.substr(pos+1);
+  str = str.substr(pos+1);
+  pos = str.find(",");
+  std::string protocol_s = str.substr(0, pos);
   if (protocol_map.find(protocol_s) == protocol_map.end()) {
     LOG(ERROR) << "Unknown or invalid protocol, value=" << protocol_s;
     return false;
   }
-  uint8_t protocol = protocol_map[protocol_s];
 
   DLOG(INFO) << "Port:" << port_id << ",protocol:" << protocol_s;
 
-  rule_key = (uint8_t)(port_id-1) | (protocol << 8);
+  conditions.port_id = (uint8_t)(port_id-1);
+  conditions.protocol = protocol_map[protocol_s];
+
+  // Optional conditions: src=a.b.c.d/len, dst=a.b.c.d/len, sport=min-max, dport=min-max, vlan=vid
+  while (pos != std::string::npos) {
+    str = str.substr(pos+1);
+    pos = str.find(",");
+    std::string cond_s = str.substr(0, pos);
+
+    if (cond_s.compare(0, src_prefix.length(), src_prefix) == 0) {
+      if (!ParseIpv4Prefix(cond_s.substr(src_prefix.length()), conditions.src_addr, conditions.src_len)) {
+        LOG(ERROR) << "Invalid src prefix, value=" << cond_s;
+        return false;
+      }
+    }
+    else if (cond_s.compare(0, dst_prefix.length(), dst_prefix) == 0) {
+      if (!ParseIpv4Prefix(cond_s.substr(dst_prefix.length()), conditions.dst_addr, conditions.dst_len)) {
+        LOG(ERROR) << "Invalid dst prefix, value=" << cond_s;
+        return false;
+      }
+    }
+    else if (cond_s.compare(0, sport_prefix.length(), sport_prefix) == 0) {
+      if (!ParseRange(cond_s.substr(sport_prefix.length()), conditions.src_port_min, conditions.src_port_max)) {
+        LOG(ERROR) << "Invalid sport range, value=" << cond_s;
+        return false;
+      }
+    }
+    else if (cond_s.compare(0, dport_prefix.length(), dport_prefix) == 0) {
+      if (!ParseRange(cond_s.substr(dport_prefix.length()), conditions.dst_port_min, conditions.dst_port_max)) {
+        LOG(ERROR) << "Invalid dport range, value=" << cond_s;
+        return false;
+      }
+    }
+    else if (cond_s.compare(0, vlan_prefix.length(), vlan_prefix) == 0) {
+      unsigned long vid;
+      if (!ParseInt(cond_s.substr(vlan_prefix.length()), vid) || vid == 0 || vid > 4094) {
+        LOG(ERROR) << "Invalid vlan, value=" << cond_s;
+        return false;
+      }
+      conditions.vlan = (uint16_t)vid;
+    }
+    else {
+      LOG(ERROR) << "Unknown or invalid condition, value=" << cond_s;
+      return false;
+    }
+    DLOG(INFO) << "Condition " << cond_s;
+  }
 
   return true;
 }
@@ -109,6 +248,17 @@ bool Config::ParseActions(Actions &actions, std::string &str) {
   static const std::string push_vlan_prefix = "PUSH-VLAN(";
   static const std::string push_mpls_prefix = "PUSH-MPLS(";
   static const std::string output_prefix = "OUTPUT(";
+  static const std::string output_group_prefix = "OUTPUT-GROUP(";
+  static const std::string meter_prefix = "METER(";
+  static const std::string capture_prefix = "CAPTURE(";
+  static const std::string sample_prefix = "SAMPLE(";
+  static const std::string mirror_prefix = "MIRROR(";
+  static const std::string set_dscp_prefix = "SET-DSCP(";
+  static const std::string dec_ttl_prefix = "DEC-TTL";
+  static const std::string pop_vlan_prefix = "POP-VLAN";
+  static const std::string pop_mpls_prefix = "POP-MPLS";
+  static const std::string set_eth_dst_prefix = "SET-ETH-DST(";
+  static const std::string set_eth_src_prefix = "SET-ETH-SRC(";
 
   size_t pos;
   while((pos = str.find(";")) != std::string::npos) {
@@ -198,6 +348,195 @@ bool Config::ParseActions(Actions &actions, std::string &str) {
       actions.push_back(action);
     }
 
+    else if (action_s.find(output_group_prefix) != std::string::npos) {
+      auto output_group_prefix_len = output_group_prefix.length();
+      if (action_s.substr(0, output_group_prefix_len) != output_group_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid OUTPUT-GROUP action, value=" << action_s;
+        return false;
+      }
+      action_s = action_s.substr(output_group_prefix_len, action_s_len-output_group_prefix_len-1);
+      OutputGroupAction *output_group_action = new OutputGroupAction;
+      output_group_action->type = OUTPUT_GROUP;
+      if (!ParseOutputGroupData(*output_group_action, action_s)) {
+        delete output_group_action;
+        return false;
+      }
+      DLOG(INFO) << "Action OUTPUT-GROUP, ports=" << (uint16_t)output_group_action->nb_ports;
+      Action *action = reinterpret_cast<Action*>(output_group_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(meter_prefix) != std::string::npos) {
+      auto meter_prefix_len = meter_prefix.length();
+      if (action_s.substr(0, meter_prefix_len) != meter_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid METER action, value=" << action_s;
+        return false;
+      }
+      action_s = action_s.substr(meter_prefix_len, action_s_len-meter_prefix_len-1);
+      uint64_t rate;
+      uint32_t burst;
+      if (!ParseMeterData(rate, burst, action_s)) {
+        return false;
+      }
+      DLOG(INFO) << "Action METER, rate=" << rate << "kbit/s,burst=" << burst;
+      // Buckets are cache-aligned, operator new doesn't guarantee it
+      void *meter_mem = rte_zmalloc("meter", sizeof(Meter), CACHE_LINE_SIZE);
+      if (!meter_mem) {
+        LOG(ERROR) << "Can't allocate meter";
+        return false;
+      }
+      MeterAction *meter_action = new MeterAction;
+      meter_action->type = METER;
+      meter_action->meter = new (meter_mem) Meter(rate*1000/8, burst, rte_get_tsc_hz());
+      Action *action = reinterpret_cast<Action*>(meter_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(capture_prefix) != std::string::npos) {
+      auto capture_prefix_len = capture_prefix.length();
+      if (action_s.substr(0, capture_prefix_len) != capture_prefix || action_s[action_s_len-1] != ')' ||
+          action_s_len == capture_prefix_len + 1) {
+        LOG(ERROR) << "Invalid CAPTURE action, value=" << action_s;
+        return false;
+      }
+      std::string file_name = action_s.substr(capture_prefix_len, action_s_len-capture_prefix_len-1);
+      int capture_id = PacketCapture::Instance().Register(file_name);
+      if (capture_id < 0) {
+        return false;
+      }
+      DLOG(INFO) << "Action CAPTURE, file=" << file_name;
+      CaptureAction *capture_action = new CaptureAction;
+      capture_action->type = CAPTURE;
+      capture_action->capture_id = capture_id;
+      Action *action = reinterpret_cast<Action*>(capture_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(sample_prefix) != std::string::npos) {
+      auto sample_prefix_len = sample_prefix.length();
+      if (action_s.substr(0, sample_prefix_len) != sample_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid SAMPLE action, value=" << action_s;
+        return false;
+      }
+      action_s = action_s.substr(sample_prefix_len, action_s_len-sample_prefix_len-1);
+      uint32_t rate;
+      bool by_flow;
+      if (!ParseSampleData(rate, by_flow, action_s)) {
+        return false;
+      }
+      if (!SlowPath::Instance().Initialize()) {
+        return false;
+      }
+      DLOG(INFO) << "Action SAMPLE, rate=1/" << rate << ",by_flow=" << by_flow;
+      SampleAction *sample_action = new SampleAction;
+      sample_action->type = SAMPLE;
+      sample_action->rate = rate;
+      sample_action->by_flow = by_flow;
+      Action *action = reinterpret_cast<Action*>(sample_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(mirror_prefix) != std::string::npos) {
+      auto mirror_prefix_len = mirror_prefix.length();
+      if (action_s.substr(0, mirror_prefix_len) != mirror_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid MIRROR action, value=" << action_s;
+        return false;
+      }
+      action_s = action_s.substr(mirror_prefix_len, action_s_len-mirror_prefix_len-1);
+      uint8_t port_id;
+      uint16_t truncate_len;
+      if (!ParseMirrorData(port_id, truncate_len, action_s)) {
+        return false;
+      }
+      DLOG(INFO) << "Action MIRROR, port_id=" << (uint16_t)port_id << ",truncate=" << truncate_len;
+      MirrorAction *mirror_action = new MirrorAction;
+      mirror_action->type = MIRROR;
+      mirror_action->port_id = (uint8_t)(port_id-1);
+      mirror_action->truncate_len = truncate_len;
+      Action *action = reinterpret_cast<Action*>(mirror_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(set_dscp_prefix) != std::string::npos) {
+      auto set_dscp_prefix_len = set_dscp_prefix.length();
+      if (action_s.substr(0, set_dscp_prefix_len) != set_dscp_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid SET-DSCP action, value=" << action_s;
+        return false;
+      }
+      std::string dscp_s = action_s.substr(set_dscp_prefix_len, action_s_len-set_dscp_prefix_len-1);
+      unsigned long dscp;
+      if (!ParseInt(dscp_s, dscp)) {
+        LOG(ERROR) << "Can't convert dscp, value=" << dscp_s;
+        return false;
+      }
+      if (dscp > 63) {
+        LOG(ERROR) << "Invalid dscp value=" << dscp;
+        return false;
+      }
+      DLOG(INFO) << "Action SET-DSCP, dscp=" << dscp;
+      SetDscpAction *set_dscp_action = new SetDscpAction;
+      set_dscp_action->type = SET_DSCP;
+      set_dscp_action->dscp = (uint8_t)dscp;
+      Action *action = reinterpret_cast<Action*>(set_dscp_action);
+      actions.push_back(action);
+    }
+
+    else if (action_s.find(dec_ttl_prefix) != std::string::npos) {
+      if (action_s != dec_ttl_prefix) {
+        LOG(ERROR) << "Invalid DEC-TTL action, value=" << action_s;
+        return false;
+      }
+      DLOG(INFO) << "Action DEC-TTL";
+      Action *dec_ttl_action = new Action;
+      dec_ttl_action->type = DEC_TTL;
+      actions.push_back(dec_ttl_action);
+    }
+
+    else if (action_s.find(pop_vlan_prefix) != std::string::npos) {
+      if (action_s != pop_vlan_prefix) {
+        LOG(ERROR) << "Invalid POP-VLAN action, value=" << action_s;
+        return false;
+      }
+      DLOG(INFO) << "Action POP-VLAN";
+      Action *pop_vlan_action = new Action;
+      pop_vlan_action->type = POP_VLAN;
+      actions.push_back(pop_vlan_action);
+    }
+
+    else if (action_s.find(pop_mpls_prefix) != std::string::npos) {
+      if (action_s != pop_mpls_prefix) {
+        LOG(ERROR) << "Invalid POP-MPLS action, value=" << action_s;
+        return false;
+      }
+      DLOG(INFO) << "Action POP-MPLS";
+      Action *pop_mpls_action = new Action;
+      pop_mpls_action->type = POP_MPLS;
+      actions.push_back(pop_mpls_action);
+    }
+
+    else if (action_s.find(set_eth_dst_prefix) != std::string::npos ||
+             action_s.find(set_eth_src_prefix) != std::string::npos) {
+      const bool dst = action_s.find(set_eth_dst_prefix) != std::string::npos;
+      const std::string &set_eth_prefix = dst ? set_eth_dst_prefix : set_eth_src_prefix;
+      auto set_eth_prefix_len = set_eth_prefix.length();
+      if (action_s.substr(0, set_eth_prefix_len) != set_eth_prefix || action_s[action_s_len-1] != ')') {
+        LOG(ERROR) << "Invalid SET-ETH action, value=" << action_s;
+        return false;
+      }
+      std::string addr_s = action_s.substr(set_eth_prefix_len, action_s_len-set_eth_prefix_len-1);
+      ether_addr addr;
+      if (!ParseEthAddr(addr_s, addr)) {
+        LOG(ERROR) << "Invalid mac address value=" << addr_s;
+        return false;
+      }
+      DLOG(INFO) << "Action " << (dst ? "SET-ETH-DST" : "SET-ETH-SRC") << ", addr=" << addr_s;
+      SetEthAction *set_eth_action = new SetEthAction;
+      set_eth_action->type = dst ? SET_ETH_DST : SET_ETH_SRC;
+      set_eth_action->addr = addr;
+      Action *action = reinterpret_cast<Action*>(set_eth_action);
+      actions.push_back(action);
+    }
+
     else {
       LOG(ERROR) << "Unknown or invalid action, value=" << action_s;
       return false;
@@ -347,3 +686,138 @@ bool Config::ParseMplsData(uint32_t &label, uint8_t &exp, uint8_t &bos, uint8_t
 
   return true;
 }
+
+bool Config::ParseMeterData(uint64_t &rate, uint32_t &burst, std::string &str) {
+  static constexpr uint32_t max_burst = 1 << 24;
+
+  auto pos = str.find(",");
+  if (pos == std::string::npos) {
+    LOG(ERROR) << "Can't parse meter rate (delimeter not found)";
+    return false;
+  }
+  std::string rate_s = str.substr(0, pos);
+  unsigned long ret;
+  if (!ParseInt(rate_s, ret)) {
+    LOG(ERROR) << "Can't convert meter rate, value=" << rate_s;
+    return false;
+  }
+  rate = ret;
+  if (rate == 0 || rate > UINT32_MAX) {
+    LOG(ERROR) << "Invalid meter rate value=" << rate;
+    return false;
+  }
+
+  std::string burst_s = str.substr(pos+1);
+  if (!ParseInt(burst_s, ret)) {
+    LOG(ERROR) << "Can't convert meter burst, value=" << burst_s;
+    return false;
+  }
+  if (ret < ETHER_MIN_LEN || ret > max_burst) {
+    LOG(ERROR) << "Invalid meter burst value=" << ret;
+    return false;
+  }
+  burst = (uint32_t)ret;
+
+  return true;
+}
+
+// Format is 1/N or 1/N,flow
+bool Config::ParseSampleData(uint32_t &rate, bool &by_flow, std::string &str) {
+  static const std::string rate_prefix = "1/";
+  static const std::string flow_suffix = ",flow";
+
+  by_flow = false;
+  if (str.length() > flow_suffix.length() && str.substr(str.length()-flow_suffix.length()) == flow_suffix) {
+    by_flow = true;
+    str = str.substr(0, str.length()-flow_suffix.length());
+  }
+  if (str.substr(0, rate_prefix.length()) != rate_prefix) {
+    LOG(ERROR) << "Can't parse sample rate, value=" << str;
+    return false;
+  }
+  std::string rate_s = str.substr(rate_prefix.length());
+  unsigned long ret;
+  if (!ParseInt(rate_s, ret)) {
+    LOG(ERROR) << "Can't convert sample rate, value=" << rate_s;
+    return false;
+  }
+  if (ret == 0 || ret > UINT16_MAX) {
+    LOG(ERROR) << "Invalid sample rate value=1/" << ret;
+    return false;
+  }
+  rate = (uint32_t)ret;
+
+  return true;
+}
+
+// Format is port or port,truncate=N
+bool Config::ParseMirrorData(uint8_t &port_id, uint16_t &truncate_len, std::string &str) {
+  static const std::string truncate_prefix = "truncate=";
+  static constexpr unsigned long min_truncate_len = ETHER_MIN_LEN - ETHER_CRC_LEN;
+
+  truncate_len = 0;
+  auto pos = str.find(",");
+  std::string port_id_s = str.substr(0, pos);
+  unsigned long ret;
+  if (!ParseInt(port_id_s, ret)) {
+    LOG(ERROR) << "Can't convert mirror port_id, value=" << port_id_s;
+    return false;
+  }
+  if (!PortIdIsValid(ret)) {
+    LOG(ERROR) << "Invalid port_id value=" << ret;
+    return false;
+  }
+  port_id = (uint8_t)ret;
+  if (pos == std::string::npos) {
+    return true;
+  }
+
+  str = str.substr(pos+1);
+  if (str.substr(0, truncate_prefix.length()) != truncate_prefix) {
+    LOG(ERROR) << "Can't parse mirror truncate length, value=" << str;
+    return false;
+  }
+  std::string truncate_s = str.substr(truncate_prefix.length());
+  if (!ParseInt(truncate_s, ret)) {
+    LOG(ERROR) << "Can't convert mirror truncate length, value=" << truncate_s;
+    return false;
+  }
+  if (ret < min_truncate_len || ret > UINT16_MAX) {
+    LOG(ERROR) << "Invalid mirror truncate length value=" << ret;
+    return false;
+  }
+  truncate_len = (uint16_t)ret;
+
+  return true;
+}
+
+// Format is port,port,...
+bool Config::ParseOutputGroupData(OutputGroupAction &action, std::string &str) {
+  action.nb_ports = 0;
+  size_t pos;
+  do {
+    pos = str.find(",");
+    std::string port_id_s = str.substr(0, pos);
+    unsigned long port_id;
+    if (!ParseInt(port_id_s, port_id)) {
+      LOG(ERROR) << "Can't convert output group port_id, value=" << port_id_s;
+      return false;
+    }
+    if (!PortIdIsValid(port_id)) {
+      LOG(ERROR) << "Invalid port_id value=" << port_id;
+      return false;
+    }
+    if (action.nb_ports == kMAX_GROUP_PORTS) {
+      LOG(ERROR) << "Too many ports in output group, limit is " << (uint16_t)kMAX_GROUP_PORTS;
+      return false;
+    }
+    if (std::find(action.port_ids, action.port_ids + action.nb_ports, port_id - 1) != action.port_ids + action.nb_ports) {
+      LOG(ERROR) << "Duplicate port_id in output group, value=" << port_id;
+      return false;
+    }
+    action.port_ids[action.nb_ports++] = (uint8_t)(port_id - 1);
+    str = str.substr(pos+1);
+  } while (pos != std::string::npos);
+
+  return true;
+}
@@ -3,10 +3,38 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 #include "action.h"
+#include "classifier.h"
+#include "qsbr.h"
 
 using Actions = std::vector<Action *>;
 
+// Set of rules which isn't changed after loading, it's replaced as a whole on reload
+class RuleTable {
+ public:
+  RuleTable();
+  ~RuleTable();
+
+  RuleTable(const RuleTable &) = delete;
+  RuleTable &operator=(const RuleTable &) = delete;
+  RuleTable(RuleTable &&) = delete;
+  RuleTable &operator=(RuleTable &&) = delete;
+
+  bool Add(const RuleConditions &, const Actions &);
+  bool Build();
+  void Classify(const uint8_t **, uint32_t *, const uint32_t) const;
+  const Actions *GetActions(const uint32_t) const;
+  size_t Size() const;
+  bool HasFlowSampling() const;
+
+ private:
+  std::vector<RuleConditions> conditions_;
+  std::vector<Actions> actions_;
+  Classifier classifier_;
+  bool flow_sampling_;   // SAMPLE by flow is used, so packets need flow key
+};
+
 class Config {
  public:
   explicit Config(const std::string &);
@@ -18,17 +46,23 @@ class Config {
   Config &operator=(Config &&) = delete;
 
   bool Initialize();
-  void GetActions(const uint16_t, Actions *&);
+  bool Reload(Qsbr &);
+  const RuleTable *GetRules() const;
 
  protected:
-  bool ParsePortAndProtocol(uint16_t &, std::string &);
+  RuleTable *Load();
+  bool ParseConditions(RuleConditions &, std::string &);
   bool ParseActions(Actions &, std::string &);
   bool ParseVlanData(uint16_t &, uint8_t &, uint8_t &, uint16_t &, std::string &);
   bool ParseMplsData(uint32_t &, uint8_t &, uint8_t &, uint8_t &, std::string &);
+  bool ParseMeterData(uint64_t &, uint32_t &, std::string &);
+  bool ParseSampleData(uint32_t &, bool &, std::string &);
+  bool ParseMirrorData(uint8_t &, uint16_t &, std::string &);
+  bool ParseOutputGroupData(OutputGroupAction &, std::string &);
 
  private:
   std::string config_name_;
-  std::unordered_map<uint16_t, Actions> rules_;
+  std::atomic<RuleTable *> rules_;
 };
 
 #endif // CONFIG_
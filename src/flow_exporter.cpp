@@ -0,0 +1,222 @@
+#include "flow_exporter.h"
+#include <glog/logging.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <ctime>
+#include <rte_cycles.h>
+
+static constexpr uint16_t kIPFIX_VERSION = 10;
+static constexpr uint16_t kIPFIX_HEADER_LEN = 16;
+static constexpr uint16_t kIPFIX_SET_HEADER_LEN = 4;
+static constexpr uint16_t kIPFIX_TEMPLATE_SET_ID = 2;
+static constexpr uint16_t kIPFIX_TEMPLATE_IPV4 = 256;
+static constexpr uint16_t kIPFIX_TEMPLATE_IPV6 = 257;
+// Enterprise-specific elements use the number reserved for documentation (RFC 5612)
+static constexpr uint32_t kIPFIX_ENTERPRISE_ID = 32473;
+static constexpr uint16_t kIPFIX_ENTERPRISE_BIT = 0x8000;
+// Classification engine for user-defined applications (RFC 6759)
+static constexpr uint8_t kIPFIX_APP_ENGINE_USER = 6;
+
+struct IpfixField {
+  uint16_t id;
+  uint16_t len;
+};
+
+// Information elements which follow addresses in both templates
+static const IpfixField kIPFIX_COMMON_FIELDS[] = {
+  {7, 2},    // sourceTransportPort
+  {11, 2},   // destinationTransportPort
+  {4, 1},    // protocolIdentifier
+  {10, 4},   // ingressInterface
+  {95, 4},   // applicationId (protocol_type)
+  {2, 8},    // packetDeltaCount
+  {1, 8},    // octetDeltaCount
+  {152, 8},  // flowStartMilliseconds
+  {153, 8},  // flowEndMilliseconds
+  {static_cast<uint16_t>(kIPFIX_ENTERPRISE_BIT | 1), 4}, // number of matched rule
+};
+static constexpr uint16_t kIPFIX_COMMON_FIELDS_NUMBER = sizeof(kIPFIX_COMMON_FIELDS) / sizeof(IpfixField);
+static constexpr uint16_t kIPFIX_TEMPLATE_SET_LEN = kIPFIX_SET_HEADER_LEN +
+    2 * (4 + 2*4 + kIPFIX_COMMON_FIELDS_NUMBER*4 + 4);
+static constexpr uint16_t kIPFIX_MAX_RECORD_LEN = 2*16 + 2 + 2 + 1 + 4 + 4 + 4*8 + 4;
+
+FlowExporter::FlowExporter(const uint32_t addr, const uint16_t port)
+    : addr_(addr), port_(port), socket_(-1), sequence_(0), messages_(0), records_(0), exported_(0),
+      base_ms_(0), base_tsc_(0), tsc_hz_(rte_get_tsc_hz()), len_(0), set_offset_(0), set_id_(0) {
+  StartMessage();
+}
+
+FlowExporter::~FlowExporter() {
+  if (socket_ >= 0) {
+    close(socket_);
+  }
+}
+
+bool FlowExporter::Initialize() {
+  socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+  if (socket_ < 0) {
+    LOG(ERROR) << "Can't create socket for IPFIX export";
+    return false;
+  }
+  sockaddr_in collector{};
+  collector.sin_family = AF_INET;
+  collector.sin_addr.s_addr = htonl(addr_);
+  collector.sin_port = htons(port_);
+  if (connect(socket_, (const sockaddr *)&collector, sizeof(collector)) < 0) {
+    LOG(ERROR) << "Can't connect to IPFIX collector";
+    return false;
+  }
+
+  // Flows are timestamped by TSC, it's converted to wall-clock time at export
+  timeval tv;
+  gettimeofday(&tv, nullptr);
+  base_ms_ = (uint64_t)tv.tv_sec * MS_PER_S + tv.tv_usec / (US_PER_S / MS_PER_S);
+  base_tsc_ = rte_rdtsc();
+
+  return true;
+}
+
+void FlowExporter::Export(const FlowRecord *records, const uint32_t n) {
+  for (uint32_t i = 0; i < n; ++i) {
+    if (len_ + kIPFIX_SET_HEADER_LEN + kIPFIX_MAX_RECORD_LEN > kIPFIX_MAX_MESSAGE_LEN) {
+      Flush();
+    }
+    AddRecord(records[i]);
+  }
+}
+
+void FlowExporter::Flush() {
+  if (records_ == 0) {
+    return;
+  }
+  const uint8_t *message;
+  const uint16_t len = FinishMessage(message);
+  if (send(socket_, message, len, 0) < 0) {
+    LOG(WARNING) << "IPFIX message of " << records_ << " records wasn't sent";
+  }
+  else {
+    exported_ += records_;
+  }
+  Reset();
+}
+
+uint64_t FlowExporter::GetExported() const {
+  return exported_;
+}
+
+void FlowExporter::AddRecord(const FlowRecord &record) {
+  const uint16_t template_id = record.key.ipv6 ? kIPFIX_TEMPLATE_IPV6 : kIPFIX_TEMPLATE_IPV4;
+  if (set_id_ != template_id) {
+    FinishSet();
+    set_offset_ = len_;
+    set_id_ = template_id;
+    Put16(template_id);
+    Put16(0); // length is set at the end
+  }
+
+  const uint16_t addr_len = record.key.ipv6 ? 16 : 4;
+  PutBytes(record.key.src_addr, addr_len);
+  PutBytes(record.key.dst_addr, addr_len);
+  Put16(record.key.src_port);
+  Put16(record.key.dst_port);
+  Put8(record.key.proto);
+  Put32(record.port_id);
+  Put32((uint32_t)kIPFIX_APP_ENGINE_USER << 24 | record.protocol);
+  Put64(record.packets);
+  Put64(record.bytes);
+  Put64(TscToMs(record.first_tsc));
+  Put64(TscToMs(record.last_tsc));
+  Put32(record.rule);
+  ++records_;
+}
+
+// Lengths and export time are filled in, message is valid until Reset
+uint16_t FlowExporter::FinishMessage(const uint8_t *&message) {
+  FinishSet();
+  *(uint16_t *)(message_ + 2) = rte_cpu_to_be_16(len_);
+  *(uint32_t *)(message_ + 4) = rte_cpu_to_be_32((uint32_t)time(nullptr));
+  message = message_;
+
+  return len_;
+}
+
+void FlowExporter::Reset() {
+  sequence_ += records_;
+  ++messages_;
+  StartMessage();
+}
+
+void FlowExporter::StartMessage() {
+  len_ = 0;
+  records_ = 0;
+  set_offset_ = 0;
+  set_id_ = 0;
+
+  Put16(kIPFIX_VERSION);
+  Put16(0);  // length
+  Put32(0);  // export time
+  Put32(sequence_);
+  Put32(0);  // observation domain
+
+  // Collector can't decode data without templates, UDP doesn't guarantee they are delivered once
+  if (messages_ % kIPFIX_TEMPLATE_PERIOD == 0) {
+    Put16(kIPFIX_TEMPLATE_SET_ID);
+    Put16(kIPFIX_TEMPLATE_SET_LEN);
+    for (const auto template_id : {kIPFIX_TEMPLATE_IPV4, kIPFIX_TEMPLATE_IPV6}) {
+      Put16(template_id);
+      Put16(2 + kIPFIX_COMMON_FIELDS_NUMBER);
+      // sourceIPv4Address/destinationIPv4Address or sourceIPv6Address/destinationIPv6Address
+      const bool ipv4 = template_id == kIPFIX_TEMPLATE_IPV4;
+      Put16(ipv4 ? 8 : 27);
+      Put16(ipv4 ? 4 : 16);
+      Put16(ipv4 ? 12 : 28);
+      Put16(ipv4 ? 4 : 16);
+      for (const auto &field : kIPFIX_COMMON_FIELDS) {
+        Put16(field.id);
+        Put16(field.len);
+        if (field.id & kIPFIX_ENTERPRISE_BIT) {
+          Put32(kIPFIX_ENTERPRISE_ID);
+        }
+      }
+    }
+  }
+}
+
+void FlowExporter::FinishSet() {
+  if (set_offset_) {
+    *(uint16_t *)(message_ + set_offset_ + 2) = rte_cpu_to_be_16(len_ - set_offset_);
+    set_offset_ = 0;
+    set_id_ = 0;
+  }
+}
+
+uint64_t FlowExporter::TscToMs(const uint64_t tsc) const {
+  const int64_t diff_ms = ((int64_t)(tsc - base_tsc_)) / (int64_t)(tsc_hz_ / MS_PER_S);
+  return base_ms_ + diff_ms;
+}
+
+void FlowExporter::Put8(const uint8_t value) {
+  message_[len_++] = value;
+}
+
+void FlowExporter::Put16(const uint16_t value) {
+  const uint16_t be_value = rte_cpu_to_be_16(value);
+  PutBytes(&be_value, sizeof(be_value));
+}
+
+void FlowExporter::Put32(const uint32_t value) {
+  const uint32_t be_value = rte_cpu_to_be_32(value);
+  PutBytes(&be_value, sizeof(be_value));
+}
+
+void FlowExporter::Put64(const uint64_t value) {
+  const uint64_t be_value = rte_cpu_to_be_64(value);
+  PutBytes(&be_value, sizeof(be_value));
+}
+
+void FlowExporter::PutBytes(const void *data, const uint16_t len) {
+  memcpy(message_ + len_, data, len);
+  len_ += len;
+}
@@ -0,0 +1,56 @@
+#ifndef FLOW_EXPORTER_
+#define FLOW_EXPORTER_
+
+#include "flow_table.h"
+
+static constexpr uint16_t kIPFIX_MAX_MESSAGE_LEN = 1400;  // fits into single UDP packet
+static constexpr uint16_t kIPFIX_TEMPLATE_PERIOD = 64;    // templates are resent after so many messages
+
+// Sends flow records to IPFIX collector over UDP. It's used by single non-processing lcore.
+class FlowExporter {
+ public:
+  FlowExporter(const uint32_t, const uint16_t);
+  ~FlowExporter();
+
+  FlowExporter(const FlowExporter &) = delete;
+  FlowExporter &operator=(const FlowExporter &) = delete;
+  FlowExporter(FlowExporter &&) = delete;
+  FlowExporter &operator=(FlowExporter &&) = delete;
+
+  bool Initialize();
+  void Export(const FlowRecord *, const uint32_t);
+  void Flush();
+  uint64_t GetExported() const;
+
+  // Message building (without sending)
+  void AddRecord(const FlowRecord &);
+  uint16_t FinishMessage(const uint8_t *&);
+  void Reset();
+
+ private:
+  void StartMessage();
+  void FinishSet();
+  uint64_t TscToMs(const uint64_t) const;
+  void Put8(const uint8_t);
+  void Put16(const uint16_t);
+  void Put32(const uint32_t);
+  void Put64(const uint64_t);
+  void PutBytes(const void *, const uint16_t);
+
+  uint32_t addr_; // host order
+  uint16_t port_;
+  int socket_;
+  uint32_t sequence_;  // data records sent before current message
+  uint32_t messages_;
+  uint32_t records_;   // records in current message
+  uint64_t exported_;
+  uint64_t base_ms_;
+  uint64_t base_tsc_;
+  uint64_t tsc_hz_;
+  uint16_t len_;
+  uint16_t set_offset_; // 0 - no open data set
+  uint16_t set_id_;
+  uint8_t message_[kIPFIX_MAX_MESSAGE_LEN];
+};
+
+#endif // FLOW_EXPORTER_
@@ -0,0 +1,120 @@
+#include "flow_table.h"
+#include <cassert>
+
+FlowTable::FlowTable(const uint8_t port_id, const uint32_t size, const uint64_t idle_timeout_tsc,
+                     const uint64_t active_timeout_tsc)
+    : port_id_(port_id),
+      mask_(size - 1),
+      idle_timeout_tsc_(idle_timeout_tsc),
+      active_timeout_tsc_(active_timeout_tsc),
+      scan_pos_(0),
+      scan_tsc_(0),
+      scan_credit_(0),
+      entries_(size),
+      drops_(0),
+      evictions_(0),
+      head_(0),
+      tail_(0),
+      ring_(size) {
+  assert(rte_is_power_of_2(size) && size >= kFLOW_BUCKET_ENTRIES);
+  memset(entries_.data(), 0, size * sizeof(Entry));
+}
+
+void FlowTable::Update(const FlowKey &key, const uint32_t hash, const protocol_type protocol, const uint32_t rule,
+                       const uint32_t bytes, const uint64_t cur_tsc) {
+  Entry *bucket = &entries_[hash & mask_ & ~(kFLOW_BUCKET_ENTRIES - 1)];
+  Entry *entry = nullptr;
+  Entry *free_entry = nullptr;
+  Entry *lru_entry = nullptr;
+  for (uint32_t i = 0; i < kFLOW_BUCKET_ENTRIES; ++i) {
+    Entry &cur = bucket[i];
+    if (!cur.active) {
+      free_entry = free_entry ? free_entry : &cur;
+    }
+    else if (cur.hash == hash && memcmp(&cur.record.key, &key, sizeof(key)) == 0) {
+      entry = &cur;
+      break;
+    }
+    else if (!lru_entry || cur.record.last_tsc < lru_entry->record.last_tsc) {
+      lru_entry = &cur;
+    }
+  }
+
+  if (!entry) {
+    entry = free_entry;
+    if (!entry) {
+      entry = lru_entry;
+      Finish(*entry);
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    memcpy(&entry->record.key, &key, sizeof(key));
+    entry->record.packets = 0;
+    entry->record.bytes = 0;
+    entry->record.first_tsc = cur_tsc;
+    entry->record.port_id = port_id_;
+    entry->hash = hash;
+    entry->active = true;
+  }
+  entry->record.packets++;
+  entry->record.bytes += bytes;
+  entry->record.last_tsc = cur_tsc;
+  // The last result is kept, it may change after rules reload
+  entry->record.rule = rule;
+  entry->record.protocol = protocol;
+}
+
+// Only part of table is checked at once, so the cost is spread between timer ticks.
+// The number of entries grows with elapsed time, the whole table is checked once per idle timeout.
+void FlowTable::Expire(const uint64_t cur_tsc) {
+  const uint64_t elapsed_tsc = RTE_MIN(cur_tsc - scan_tsc_, idle_timeout_tsc_);
+  scan_tsc_ = cur_tsc;
+  scan_credit_ += elapsed_tsc * (mask_ + 1);
+  const uint64_t nb_entries = scan_credit_ / idle_timeout_tsc_;
+  scan_credit_ -= nb_entries * idle_timeout_tsc_;
+  for (uint64_t i = 0; i < RTE_MIN(nb_entries, (uint64_t)mask_ + 1); ++i) {
+    Entry &entry = entries_[scan_pos_];
+    scan_pos_ = (scan_pos_ + 1) & mask_;
+    if (entry.active && (cur_tsc - entry.record.last_tsc >= idle_timeout_tsc_ ||
+                         cur_tsc - entry.record.first_tsc >= active_timeout_tsc_)) {
+      Finish(entry);
+    }
+  }
+}
+
+void FlowTable::ExpireAll() {
+  for (auto &entry : entries_) {
+    if (entry.active) {
+      Finish(entry);
+    }
+  }
+}
+
+uint64_t FlowTable::GetDrops() const {
+  return drops_.load(std::memory_order_relaxed);
+}
+
+uint64_t FlowTable::GetEvictions() const {
+  return evictions_.load(std::memory_order_relaxed);
+}
+
+uint32_t FlowTable::Dequeue(FlowRecord *records, const uint32_t n) {
+  const uint32_t head = head_.load(std::memory_order_relaxed);
+  const uint32_t count = RTE_MIN(tail_.load(std::memory_order_acquire) - head, n);
+  for (uint32_t i = 0; i < count; ++i) {
+    records[i] = ring_[(head + i) & mask_];
+  }
+  head_.store(head + count, std::memory_order_release);
+
+  return count;
+}
+
+void FlowTable::Finish(Entry &entry) {
+  entry.active = false;
+  const uint32_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - head_.load(std::memory_order_acquire) == ring_.size()) {
+    drops_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  ring_[tail & mask_] = entry.record;
+  tail_.store(tail + 1, std::memory_order_release);
+}
@@ -0,0 +1,71 @@
+#ifndef FLOW_TABLE_
+#define FLOW_TABLE_
+
+#include <atomic>
+#include <vector>
+#include "heavy_hitters.h"
+
+static constexpr uint32_t kFLOW_BUCKET_ENTRIES = 8;       // flows with the same hash bucket
+
+// Finished flow which is exported to collector
+struct FlowRecord {
+  FlowKey key;
+  uint64_t packets;
+  uint64_t bytes;
+  uint64_t first_tsc;
+  uint64_t last_tsc;
+  uint32_t rule;        // 0 - no rule was matched, otherwise number of rule in config
+  uint8_t port_id;
+  protocol_type protocol;
+};
+
+// Active flows of single lcore. Table is set-associative: new flow takes free entry of its bucket
+// or finishes the least recently updated one. Finished flows are passed to exporter through
+// single-producer single-consumer ring of the table size, they are dropped if exporter doesn't keep up.
+class FlowTable {
+ public:
+  // Size must be power of 2 not less than bucket
+  FlowTable(const uint8_t, const uint32_t, const uint64_t, const uint64_t);
+  ~FlowTable() = default;
+
+  FlowTable(const FlowTable &) = delete;
+  FlowTable &operator=(const FlowTable &) = delete;
+  FlowTable(FlowTable &&) = delete;
+  FlowTable &operator=(FlowTable &&) = delete;
+
+  // Producer side
+  void Update(const FlowKey &, const uint32_t, const protocol_type, const uint32_t, const uint32_t, const uint64_t);
+  void Expire(const uint64_t);
+  void ExpireAll();
+  uint64_t GetDrops() const;
+  uint64_t GetEvictions() const;
+
+  // Consumer side
+  uint32_t Dequeue(FlowRecord *, const uint32_t);
+
+ private:
+  struct Entry {
+    FlowRecord record;
+    uint32_t hash;
+    bool active;
+  };
+
+  void Finish(Entry &);
+
+  uint8_t port_id_;
+  uint32_t mask_;         // table and ring size - 1
+  uint64_t idle_timeout_tsc_;
+  uint64_t active_timeout_tsc_;
+  uint32_t scan_pos_;
+  uint64_t scan_tsc_;     // time of the previous expiry check
+  uint64_t scan_credit_;  // entries to check multiplied by idle timeout
+  std::vector<Entry> entries_;
+  std::atomic<uint64_t> drops_;
+  std::atomic<uint64_t> evictions_;
+
+  std::atomic<uint32_t> head_ __attribute__((aligned(CACHE_LINE_SIZE)));
+  std::atomic<uint32_t> tail_ __attribute__((aligned(CACHE_LINE_SIZE)));
+  std::vector<FlowRecord> ring_;
+};
+
+#endif // FLOW_TABLE_
@@ -0,0 +1,81 @@
+#include "fragment_table.h"
+#include <rte_ip.h>
+#include <rte_jhash.h>
+
+static constexpr uint16_t kIPV6_FRAG_OFFSET_MASK = 0xfff8;
+
+bool GetFragmentKey(const rte_mbuf *m, FragmentKey &key, bool &first) {
+  const uint16_t offset = m->outer_l2_len + m->outer_l3_len + m->l2_len;
+  const uint16_t l3_len = m->l3_len;
+  char buf[kMAX_HEADERS_LEN];
+  if (offset + l3_len > kMAX_HEADERS_LEN) {
+    return false;
+  }
+  const char *data = (const char *)ReadMbufData(m, offset, l3_len, buf);
+  if (!data) {
+    return false;
+  }
+
+  memset(&key, 0, sizeof(key));
+  switch (m->packet_type & RTE_PTYPE_L3_MASK) {
+    case RTE_PTYPE_L3_IPV4:
+    case RTE_PTYPE_L3_IPV4_EXT: {
+      if (l3_len < sizeof(ipv4_hdr)) {
+        return false;
+      }
+      const ipv4_hdr *ipv4 = (const ipv4_hdr *)data;
+      memcpy(key.src_addr, &ipv4->src_addr, sizeof(ipv4->src_addr));
+      memcpy(key.dst_addr, &ipv4->dst_addr, sizeof(ipv4->dst_addr));
+      key.id = ipv4->packet_id;
+      key.proto = ipv4->next_proto_id;
+      first = !(rte_be_to_cpu_16(ipv4->fragment_offset) & IPV4_HDR_OFFSET_MASK);
+      break;
+    }
+    case RTE_PTYPE_L3_IPV6:
+    case RTE_PTYPE_L3_IPV6_EXT: {
+      uint16_t hdrs_len, frag_offset;
+      uint8_t ip_proto;
+      if (!ParseIpv6Headers(data, l3_len, 0, hdrs_len, ip_proto, frag_offset) || !frag_offset) {
+        return false;
+      }
+      const ipv6_hdr *ipv6 = (const ipv6_hdr *)data;
+      memcpy(key.src_addr, ipv6->src_addr, sizeof(ipv6->src_addr));
+      memcpy(key.dst_addr, ipv6->dst_addr, sizeof(ipv6->dst_addr));
+      // Fragment header: next header, reserved, offset with flags, identification
+      key.id = *(const uint32_t *)(data + frag_offset + 4);
+      first = !(rte_be_to_cpu_16(*(const uint16_t *)(data + frag_offset + 2)) & kIPV6_FRAG_OFFSET_MASK);
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+FragmentTable::FragmentTable(const uint64_t timeout_tsc) : timeout_tsc_(timeout_tsc) {
+  memset(&entries_, 0, sizeof(entries_));
+}
+
+void FragmentTable::Add(const FragmentKey &key, const protocol_type protocol, const uint64_t cur_tsc) {
+  // Existing entry is replaced on collision
+  Entry &entry = entries_[GetIndex(key)];
+  memcpy(&entry.key, &key, sizeof(key));
+  entry.expire_tsc = cur_tsc + timeout_tsc_;
+  entry.protocol = protocol;
+}
+
+bool FragmentTable::Lookup(const FragmentKey &key, const uint64_t cur_tsc, protocol_type &protocol) const {
+  const Entry &entry = entries_[GetIndex(key)];
+  if (entry.expire_tsc <= cur_tsc || memcmp(&entry.key, &key, sizeof(key)) != 0) {
+    return false;
+  }
+  protocol = entry.protocol;
+
+  return true;
+}
+
+uint32_t FragmentTable::GetIndex(const FragmentKey &key) const {
+  return rte_jhash(&key, sizeof(key), 0) & (kFRAGMENT_TABLE_SIZE - 1);
+}
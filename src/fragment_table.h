@@ -0,0 +1,47 @@
+#ifndef FRAGMENT_TABLE_
+#define FRAGMENT_TABLE_
+
+#include "common.h"
+
+static constexpr uint16_t kFRAGMENT_TABLE_SIZE = 1024; // must be power of 2
+
+// Identifies fragments of the same IP packet (IPv4 addresses use first 4 bytes)
+struct FragmentKey {
+  uint8_t src_addr[16];
+  uint8_t dst_addr[16];
+  uint32_t id;
+  uint8_t proto;
+};
+
+bool GetFragmentKey(const rte_mbuf *, FragmentKey &, bool &);
+
+// Keeps protocols of first fragments, so non-first fragments (which don't have L4 header)
+// are classified without analysis. Table is direct-mapped and owned by single lcore.
+// Non-first fragments which come before the first one are not classified.
+class FragmentTable {
+ public:
+  explicit FragmentTable(const uint64_t);
+  ~FragmentTable() = default;
+
+  FragmentTable(const FragmentTable &) = delete;
+  FragmentTable &operator=(const FragmentTable &) = delete;
+  FragmentTable(FragmentTable &&) = delete;
+  FragmentTable &operator=(FragmentTable &&) = delete;
+
+  void Add(const FragmentKey &, const protocol_type, const uint64_t);
+  bool Lookup(const FragmentKey &, const uint64_t, protocol_type &) const;
+
+ private:
+  struct Entry {
+    FragmentKey key;
+    uint64_t expire_tsc;
+    protocol_type protocol;
+  };
+
+  uint32_t GetIndex(const FragmentKey &) const;
+
+  uint64_t timeout_tsc_;
+  Entry entries_[kFRAGMENT_TABLE_SIZE];
+};
+
+#endif // FRAGMENT_TABLE_
@@ -0,0 +1,143 @@
+#include "heavy_hitters.h"
+#include <arpa/inet.h>
+#include <algorithm>
+#include <sstream>
+#include <rte_ip.h>
+
+static constexpr uint32_t kSKETCH_SEED = 0x9e3779b9;
+
+static bool CompareFlowsMin(const TopFlow &a, const TopFlow &b) {
+  return a.bytes > b.bytes;
+}
+
+bool GetFlowKey(const rte_mbuf *m, FlowKey &key) {
+  const uint16_t l3_offset = m->outer_l2_len + m->outer_l3_len + m->l2_len;
+  const uint16_t l4_offset = l3_offset + m->l3_len;
+  const uint16_t headers_len = RTE_MIN(l4_offset + m->l4_len, kMAX_HEADERS_LEN);
+  char buf[kMAX_HEADERS_LEN];
+  const char *data = (const char *)ReadMbufData(m, 0, headers_len, buf);
+  if (!data) {
+    return false;
+  }
+
+  memset(&key, 0, sizeof(key));
+  switch (m->packet_type & RTE_PTYPE_L3_MASK) {
+    case RTE_PTYPE_L3_IPV4:
+    case RTE_PTYPE_L3_IPV4_EXT: {
+      if (l3_offset + sizeof(ipv4_hdr) > headers_len) {
+        return false;
+      }
+      const ipv4_hdr *ipv4 = (const ipv4_hdr *)(data + l3_offset);
+      memcpy(key.src_addr, &ipv4->src_addr, sizeof(ipv4->src_addr));
+      memcpy(key.dst_addr, &ipv4->dst_addr, sizeof(ipv4->dst_addr));
+      key.proto = ipv4->next_proto_id;
+      break;
+    }
+    case RTE_PTYPE_L3_IPV6:
+    case RTE_PTYPE_L3_IPV6_EXT: {
+      // Upper-layer protocol follows extension headers (it's known for non-first fragments too)
+      uint16_t l3_len, frag_offset;
+      if (!ParseIpv6Headers(data, l4_offset, l3_offset, l3_len, key.proto, frag_offset)) {
+        return false;
+      }
+      const ipv6_hdr *ipv6 = (const ipv6_hdr *)(data + l3_offset);
+      memcpy(key.src_addr, ipv6->src_addr, sizeof(ipv6->src_addr));
+      memcpy(key.dst_addr, ipv6->dst_addr, sizeof(ipv6->dst_addr));
+      key.ipv6 = 1;
+      break;
+    }
+    default: {
+      return false;
+    }
+  }
+
+  // Non-first fragments don't have ports
+  if (m->l4_len >= 2*sizeof(uint16_t) && l4_offset + 2*sizeof(uint16_t) <= headers_len) {
+    key.src_port = rte_be_to_cpu_16(*(const uint16_t *)(data + l4_offset));
+    key.dst_port = rte_be_to_cpu_16(*(const uint16_t *)(data + l4_offset + sizeof(uint16_t)));
+  }
+
+  return true;
+}
+
+std::string FlowKeyToString(const FlowKey &key) {
+  char src[INET6_ADDRSTRLEN], dst[INET6_ADDRSTRLEN];
+  const int family = key.ipv6 ? AF_INET6 : AF_INET;
+  inet_ntop(family, key.src_addr, src, sizeof(src));
+  inet_ntop(family, key.dst_addr, dst, sizeof(dst));
+
+  std::ostringstream os;
+  os << src << ":" << key.src_port << " -> " << dst << ":" << key.dst_port << " proto=" << (uint16_t)key.proto;
+  return os.str();
+}
+
+HeavyHitters::HeavyHitters() {
+  Reset();
+}
+
+void HeavyHitters::Update(const FlowKey &key, const uint32_t hash, const protocol_type protocol,
+                          const uint32_t bytes) {
+  // Rows use different combinations of two hashes, the second one is derived from flow hash
+  const uint32_t hash1 = hash;
+  const uint32_t hash2 = MixHash(hash ^ kSKETCH_SEED) | 1;
+  uint32_t idx[kSKETCH_DEPTH];
+  uint64_t estimation = UINT64_MAX;
+  for (uint32_t i = 0; i < kSKETCH_DEPTH; ++i) {
+    idx[i] = (hash1 + i*hash2) & (kSKETCH_WIDTH - 1);
+    estimation = RTE_MIN(estimation, sketch_[i][idx[i]]);
+  }
+  // Conservative update: counters are raised only up to the new estimation
+  estimation += bytes;
+  for (uint32_t i = 0; i < kSKETCH_DEPTH; ++i) {
+    if (sketch_[i][idx[i]] < estimation) {
+      sketch_[i][idx[i]] = estimation;
+    }
+  }
+
+  TopFlow *flows = top_.flows[protocol];
+  uint8_t &count = top_.count[protocol];
+  for (uint8_t i = 0; i < count; ++i) {
+    if (memcmp(&flows[i].key, &key, sizeof(key)) == 0) {
+      flows[i].bytes = estimation;
+      std::make_heap(flows, flows + count, CompareFlowsMin);
+      return;
+    }
+  }
+  if (count < kTOP_FLOWS) {
+    flows[count].key = key;
+    flows[count].bytes = estimation;
+    std::push_heap(flows, flows + ++count, CompareFlowsMin);
+  }
+  else if (estimation > flows[0].bytes) {
+    std::pop_heap(flows, flows + count, CompareFlowsMin);
+    flows[count - 1].key = key;
+    flows[count - 1].bytes = estimation;
+    std::push_heap(flows, flows + count, CompareFlowsMin);
+  }
+}
+
+// Flows are sorted by bytes in descending order
+void HeavyHitters::GetTop(TopFlows &top) const {
+  top = top_;
+  for (uint8_t i = 0; i < kTOP_PROTOCOLS; ++i) {
+    std::sort(top.flows[i], top.flows[i] + top.count[i], CompareFlowsMin);
+  }
+}
+
+void HeavyHitters::Publish() {
+  published_.TryPublish([this](TopFlows &published) {
+    GetTop(published);
+    Reset();
+  });
+}
+
+void HeavyHitters::GetPublished(TopFlows &top) {
+  published_.Read([&top](const TopFlows &published) {
+    top = published;
+  });
+}
+
+void HeavyHitters::Reset() {
+  memset(&sketch_, 0, sizeof(sketch_));
+  memset(&top_, 0, sizeof(top_));
+}
@@ -0,0 +1,68 @@
+#ifndef HEAVY_HITTERS_
+#define HEAVY_HITTERS_
+
+#include <string>
+#include <rte_jhash.h>
+#include "common.h"
+#include "stats_window.h"
+
+static constexpr uint32_t kSKETCH_DEPTH = 4;
+static constexpr uint32_t kSKETCH_WIDTH = 512;  // must be power of 2
+static constexpr uint8_t kTOP_FLOWS = 5;        // flows kept for each protocol
+static constexpr uint8_t kTOP_PROTOCOLS = UNKNOWN + 1;
+
+// 5-tuple of inner headers (IPv4 addresses use first 4 bytes)
+struct FlowKey {
+  uint8_t src_addr[16];
+  uint8_t dst_addr[16];
+  uint16_t src_port;
+  uint16_t dst_port;
+  uint8_t proto;
+  uint8_t ipv6;
+  uint8_t pad[2];
+};
+
+bool GetFlowKey(const rte_mbuf *, FlowKey &);
+std::string FlowKeyToString(const FlowKey &);
+
+// Hash of flow key computed once per packet and shared by flow statistics
+static inline uint32_t GetFlowHash(const FlowKey &key) {
+  return rte_jhash(&key, sizeof(key), 0);
+}
+
+struct TopFlow {
+  FlowKey key;
+  uint64_t bytes; // estimation, it can only exceed real value
+};
+
+struct TopFlows {
+  TopFlow flows[kTOP_PROTOCOLS][kTOP_FLOWS];
+  uint8_t count[kTOP_PROTOCOLS];
+};
+
+// Count-min sketch of flow bytes with top flows of each protocol (min-heaps by bytes).
+// It's updated by single lcore, other lcores see only the last published window.
+class HeavyHitters {
+ public:
+  HeavyHitters();
+  ~HeavyHitters() = default;
+
+  HeavyHitters(const HeavyHitters &) = delete;
+  HeavyHitters &operator=(const HeavyHitters &) = delete;
+  HeavyHitters(HeavyHitters &&) = delete;
+  HeavyHitters &operator=(HeavyHitters &&) = delete;
+
+  void Update(const FlowKey &, const uint32_t, const protocol_type, const uint32_t);
+  void GetTop(TopFlows &) const;
+  void Publish();
+  void GetPublished(TopFlows &);
+
+ private:
+  void Reset();
+
+  uint64_t sketch_[kSKETCH_DEPTH][kSKETCH_WIDTH];
+  TopFlows top_;
+  StatsWindow<TopFlows> published_;
+};
+
+#endif // HEAVY_HITTERS_
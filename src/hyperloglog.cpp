@@ -0,0 +1,75 @@
+#include "hyperloglog.h"
+#include <cmath>
+
+HyperLogLog::HyperLogLog() {
+  Reset();
+}
+
+void HyperLogLog::Add(uint32_t hash) {
+  hash = MixHash(hash);
+  // High bits select register, the rest gives position of the first 1-bit
+  const uint32_t idx = hash >> (32 - kHLL_BITS);
+  const uint32_t rest = hash << kHLL_BITS;
+  const uint8_t rank = rest ? __builtin_clz(rest) + 1 : 32 - kHLL_BITS + 1;
+  if (registers_[idx] < rank) {
+    registers_[idx] = rank;
+  }
+}
+
+void HyperLogLog::Merge(const HyperLogLog &other) {
+  for (uint32_t i = 0; i < kHLL_REGISTERS; ++i) {
+    registers_[i] = RTE_MAX(registers_[i], other.registers_[i]);
+  }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+  static const double alpha = 0.7213 / (1.0 + 1.079 / kHLL_REGISTERS);
+  static const double two_32 = 4294967296.0;
+
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < kHLL_REGISTERS; ++i) {
+    sum += std::ldexp(1.0, -registers_[i]);
+    zeros += registers_[i] == 0;
+  }
+  double estimation = alpha * kHLL_REGISTERS * kHLL_REGISTERS / sum;
+
+  // Small and large range corrections
+  if (estimation <= 2.5 * kHLL_REGISTERS && zeros > 0) {
+    estimation = kHLL_REGISTERS * std::log((double)kHLL_REGISTERS / zeros);
+  }
+  else if (estimation > two_32 / 30) {
+    estimation = -two_32 * std::log(1.0 - estimation / two_32);
+  }
+
+  return (uint64_t)(estimation + 0.5);
+}
+
+void HyperLogLog::Reset() {
+  memset(registers_, 0, sizeof(registers_));
+}
+
+void Cardinality::Update(const protocol_type protocol, const uint32_t flow_hash, const uint32_t client_hash) {
+  current_.flows[protocol].Add(flow_hash);
+  current_.clients[protocol].Add(client_hash);
+}
+
+void Cardinality::Publish() {
+  published_.TryPublish([this](Counters &published) {
+    published = current_;
+    for (uint8_t i = 0; i < kCARDINALITY_PROTOCOLS; ++i) {
+      current_.flows[i].Reset();
+      current_.clients[i].Reset();
+    }
+  });
+}
+
+void Cardinality::GetPublished(uint64_t (&flows)[kCARDINALITY_PROTOCOLS],
+                               uint64_t (&clients)[kCARDINALITY_PROTOCOLS]) {
+  published_.Read([&flows, &clients](const Counters &published) {
+    for (uint8_t i = 0; i < kCARDINALITY_PROTOCOLS; ++i) {
+      flows[i] = published.flows[i].Estimate();
+      clients[i] = published.clients[i].Estimate();
+    }
+  });
+}
@@ -0,0 +1,52 @@
+#ifndef HYPERLOGLOG_
+#define HYPERLOGLOG_
+
+#include "common.h"
+#include "stats_window.h"
+
+static constexpr uint8_t kHLL_BITS = 10; // 2^10 registers, standard error ~3%
+static constexpr uint32_t kHLL_REGISTERS = 1U << kHLL_BITS;
+static constexpr uint8_t kCARDINALITY_PROTOCOLS = UNKNOWN + 1;
+
+// HyperLogLog counter of distinct 32-bit hashes
+class HyperLogLog {
+ public:
+  HyperLogLog();
+  ~HyperLogLog() = default;
+
+  void Add(const uint32_t);
+  void Merge(const HyperLogLog &);
+  uint64_t Estimate() const;
+  void Reset();
+
+ private:
+  uint8_t registers_[kHLL_REGISTERS];
+};
+
+// Distinct flows and clients of each protocol seen by single lcore,
+// other lcores see only the last published window.
+class Cardinality {
+ public:
+  Cardinality() = default;
+  ~Cardinality() = default;
+
+  Cardinality(const Cardinality &) = delete;
+  Cardinality &operator=(const Cardinality &) = delete;
+  Cardinality(Cardinality &&) = delete;
+  Cardinality &operator=(Cardinality &&) = delete;
+
+  void Update(const protocol_type, const uint32_t, const uint32_t);
+  void Publish();
+  void GetPublished(uint64_t (&)[kCARDINALITY_PROTOCOLS], uint64_t (&)[kCARDINALITY_PROTOCOLS]);
+
+ private:
+  struct Counters {
+    HyperLogLog flows[kCARDINALITY_PROTOCOLS];
+    HyperLogLog clients[kCARDINALITY_PROTOCOLS];
+  };
+
+  Counters current_;
+  StatsWindow<Counters> published_;
+};
+
+#endif // HYPERLOGLOG_
@@ -0,0 +1,25 @@
+#include "idle_poller.h"
+
+IdlePoller::IdlePoller(const bool intr_enabled) : empty_polls_(0), intr_enabled_(intr_enabled) {}
+
+idle_action IdlePoller::Update(const uint16_t nb_rx) {
+  if (nb_rx > 0) {
+    empty_polls_ = 0;
+    return IDLE_POLL;
+  }
+
+  if (empty_polls_ < kIDLE_INTR_POLLS) {
+    ++empty_polls_;
+  }
+  if (empty_polls_ >= kIDLE_INTR_POLLS && intr_enabled_) {
+    return IDLE_WAIT_INTR;
+  }
+  if (empty_polls_ >= kIDLE_SLEEP_POLLS) {
+    return IDLE_SLEEP;
+  }
+  if (empty_polls_ >= kIDLE_PAUSE_POLLS) {
+    return IDLE_PAUSE;
+  }
+
+  return IDLE_POLL;
+}
@@ -0,0 +1,38 @@
+#ifndef IDLE_POLLER_
+#define IDLE_POLLER_
+
+#include <stdint.h>
+
+static constexpr auto kIDLE_PAUSE_POLLS = 16;    // empty polls before pausing
+static constexpr auto kIDLE_SLEEP_POLLS = 1024;  // empty polls before sleeping
+static constexpr auto kIDLE_INTR_POLLS = 3072;   // empty polls (~100ms of sleeps) before waiting for interrupt
+static constexpr auto kIDLE_SLEEP_US = 50;       // max latency added by sleeping
+static constexpr auto kIDLE_INTR_TIMEOUT_MS = 10; // timers are checked at least so often
+
+enum idle_action: uint8_t {
+  IDLE_POLL,
+  IDLE_PAUSE,
+  IDLE_SLEEP,
+  IDLE_WAIT_INTR,
+};
+
+// Chooses what lcore does after rx-burst: the longer port is idle the deeper it sleeps,
+// the first received packet returns it to busy polling.
+class IdlePoller {
+ public:
+  explicit IdlePoller(const bool);
+  ~IdlePoller() = default;
+
+  IdlePoller(const IdlePoller &) = delete;
+  IdlePoller &operator=(const IdlePoller &) = delete;
+  IdlePoller(IdlePoller &&) = delete;
+  IdlePoller &operator=(IdlePoller &&) = delete;
+
+  idle_action Update(const uint16_t);
+
+ private:
+  uint32_t empty_polls_;
+  bool intr_enabled_; // false - sleeping is the deepest level
+};
+
+#endif // IDLE_POLLER_
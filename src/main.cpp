@@ -1,9 +1,16 @@
 #include <glog/logging.h>
 #include <csignal>
+#include <unistd.h>
 #include "packet_manager.h"
 #include "cmd_args.h"
+#include "capture.h"
+#include "slow_path.h"
+
+static constexpr auto kMASTER_LOOP_US = 1000; /* master lcore writes captured packets every 1ms */
+static constexpr auto kEXPORT_LOOPS = 100; /* flows are exported every 100ms */
 
 std::atomic<bool> terminated;
+static std::atomic<bool> reload_requested;
 
 static void sigint_handler(int sig_num) {
   (void)sig_num;
@@ -11,6 +18,12 @@ static void sigint_handler(int sig_num) {
   terminated.store(true, std::memory_order_relaxed);
 }
 
+static void sighup_handler(int sig_num) {
+  (void)sig_num;
+
+  reload_requested.store(true, std::memory_order_relaxed);
+}
+
 static int launch_lcore(void *arg) {
   ((PacketManager*)arg)->RunProcessing();
 
@@ -22,7 +35,10 @@ int main(int argc, char *argv[]) {
   google::InitGoogleLogging(argv[0]);
 
   terminated.store(false, std::memory_order_relaxed);
+  reload_requested.store(false, std::memory_order_relaxed);
   signal(SIGINT, sigint_handler);
+  signal(SIGTERM, sigint_handler);
+  signal(SIGHUP, sighup_handler);
 
   auto ret = rte_eal_init(argc, argv);
   if (ret < 0) {
@@ -36,20 +52,39 @@ int main(int argc, char *argv[]) {
   argv += ret;
   CmdArgs cmd_args = ParseArgs(argc, argv); // may throw
 
-  PacketManager packet_manager(cmd_args.config_file, cmd_args.stats_interval);
+  PacketManager packet_manager(cmd_args);
   if (!packet_manager.Initialize()) {
     rte_exit(EXIT_FAILURE, "Can't initialize packet manager\n");
   }
 
   rte_eal_mp_remote_launch(launch_lcore, (void *)(&packet_manager), SKIP_MASTER);
 
+  // Config is reloaded, flows are exported, captured packets are written and sampled ones are analyzed
+  // at master lcore, processing lcores aren't stopped
+  unsigned loops = 0;
+  while (!terminated.load(std::memory_order_relaxed)) {
+    if (reload_requested.exchange(false)) {
+      packet_manager.ReloadConfig();
+    }
+    if (++loops % kEXPORT_LOOPS == 0) {
+      packet_manager.ExportFlows();
+    }
+    PacketCapture::Instance().Write();
+    SlowPath::Instance().Process();
+    usleep(kMASTER_LOOP_US);
+  }
+
+  // Processing lcores drain their queues before they finish
+  int exit_code = EXIT_SUCCESS;
   unsigned lcore_id;
   RTE_LCORE_FOREACH_SLAVE(lcore_id) {
     if (rte_eal_wait_lcore(lcore_id) < 0) {
       LOG(ERROR) << "Wait failed for lcore_id=" << (uint16_t)lcore_id;
-      return EXIT_FAILURE;
+      exit_code = EXIT_FAILURE;
     }
   }
 
-  return EXIT_SUCCESS;
+  packet_manager.Shutdown();
+
+  return exit_code;
 }
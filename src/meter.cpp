@@ -0,0 +1,34 @@
+#include "meter.h"
+
+// Tokens are counted in 1/2^32 parts of byte, it's enough for low rates
+static constexpr auto kMETER_SHIFT = 32;
+
+// rate is in bytes per second, burst is in bytes
+Meter::Meter(const uint64_t rate, const uint32_t burst, const uint64_t tsc_hz) {
+  bytes_per_cycle_ = ((rate / tsc_hz) << kMETER_SHIFT) + (((rate % tsc_hz) << kMETER_SHIFT) / tsc_hz);
+  if (bytes_per_cycle_ == 0) {
+    bytes_per_cycle_ = 1;
+  }
+  burst_ = (uint64_t)burst << kMETER_SHIFT;
+  max_cycles_ = burst_ / bytes_per_cycle_ + 1;
+
+  for (auto &bucket : buckets_) {
+    bucket.tokens = burst_;
+    bucket.last_tsc = 0;
+  }
+}
+
+bool Meter::Conform(const unsigned lcore_id, const uint32_t len, const uint64_t cur_tsc) {
+  Bucket &bucket = buckets_[lcore_id];
+  const uint64_t cycles = RTE_MIN(cur_tsc - bucket.last_tsc, max_cycles_);
+  bucket.last_tsc = cur_tsc;
+  bucket.tokens = RTE_MIN(bucket.tokens + cycles*bytes_per_cycle_, burst_);
+
+  const uint64_t need = (uint64_t)len << kMETER_SHIFT;
+  if (bucket.tokens < need) {
+    return false;
+  }
+  bucket.tokens -= need;
+
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef METER_
+#define METER_
+
+#include <rte_config.h>
+#include "common.h"
+
+// Token bucket meter with separate bucket for each lcore, so it's updated without locks.
+// Rules are bound to input port which is processed by single lcore, so the rate is per port.
+class Meter {
+ public:
+  Meter(const uint64_t, const uint32_t, const uint64_t);
+  ~Meter() = default;
+
+  Meter(const Meter &) = delete;
+  Meter &operator=(const Meter &) = delete;
+  Meter(Meter &&) = delete;
+  Meter &operator=(Meter &&) = delete;
+
+  bool Conform(const unsigned, const uint32_t, const uint64_t);
+
+ private:
+  struct Bucket {
+    uint64_t tokens;
+    uint64_t last_tsc;
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  uint64_t bytes_per_cycle_; // fixed-point values
+  uint64_t burst_;
+  uint64_t max_cycles_;      // time to fill empty bucket
+  Bucket buckets_[RTE_MAX_LCORE];
+};
+
+#endif // METER_
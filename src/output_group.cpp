@@ -0,0 +1,35 @@
+#include "output_group.h"
+#include <rte_jhash.h>
+#include "heavy_hitters.h"
+
+// RSS hash of NIC isn't used: it includes ports of the first fragment, but not of the rest ones
+uint32_t GetSymmetricFlowHash(const rte_mbuf *m) {
+  // Hashes of endpoints are added, so the order of endpoints doesn't matter
+  FlowKey key;
+  if (!GetFlowKey(m, key)) {
+    return 0;
+  }
+  if ((m->packet_type & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_FRAG || m->l4_len == 0) {
+    key.src_port = 0;
+    key.dst_port = 0;
+  }
+  const uint8_t addr_len = key.ipv6 ? 16 : 4;
+  return rte_jhash(key.src_addr, addr_len, key.src_port) + rte_jhash(key.dst_addr, addr_len, key.dst_port) + key.proto;
+}
+
+int SelectGroupPort(const uint8_t *ports, const bool *link_up, const uint8_t nb_ports, const uint32_t hash) {
+  int selected = -1;
+  uint32_t max_weight = 0;
+  for (uint8_t i = 0; i < nb_ports; ++i) {
+    if (!link_up[i]) {
+      continue;
+    }
+    const uint32_t weight = MixHash(hash ^ MixHash(ports[i] + 1));
+    if (selected < 0 || weight > max_weight) {
+      selected = i;
+      max_weight = weight;
+    }
+  }
+
+  return selected;
+}
@@ -0,0 +1,17 @@
+#ifndef OUTPUT_GROUP_
+#define OUTPUT_GROUP_
+
+#include "common.h"
+
+static constexpr uint8_t kMAX_GROUP_PORTS = 16;
+
+// Software hash which is the same for both directions of flow: 5-tuple is hashed,
+// addresses and protocol only for fragments (so all fragments of datagram get the same hash)
+uint32_t GetSymmetricFlowHash(const rte_mbuf *);
+
+// Rendezvous (highest random weight) hashing: port with the highest weight for the hash wins,
+// so only flows of the port which went down are moved to other ports.
+// Returns index of port in group or -1 if links of all ports are down.
+int SelectGroupPort(const uint8_t *, const bool *, const uint8_t, const uint32_t);
+
+#endif // OUTPUT_GROUP_
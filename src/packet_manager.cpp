@@ -1,18 +1,59 @@
 #include <rte_config.h>
 #include <rte_cycles.h>
+#include <rte_jhash.h>
+#include <rte_malloc.h>
 #include <cassert>
+#include <new>
+#include <unistd.h>
 #include <glog/logging.h>
 #include "packet_manager.h"
 #include "packet_analyzer.h"
+#include "capture.h"
+#include "slow_path.h"
+#include "output_group.h"
 
 extern std::atomic<bool> terminated;
 
 static constexpr auto kTIMER_MILLISECOND = 2000000ULL; /* around 1ms at 2 Ghz */
 static constexpr auto kBURST_TX_DRAIN_US = 100; /* TX drain every ~100us */
+static constexpr auto kFRAGMENT_TIMEOUT_MS = 1000; /* first fragment result is kept ~1s */
+static constexpr auto kSHUTDOWN_TIMEOUT_MS = 500; /* time to drain queues on exit */
+static constexpr auto kFLOW_IDLE_TIMEOUT_S = 15; /* flow is exported after inactivity */
+static constexpr auto kFLOW_ACTIVE_TIMEOUT_S = 60; /* long flows are exported periodically */
+static constexpr auto kFLOW_EXPORT_BURST = 64;
 
-PacketManager::PacketManager(const std::string &config_name, const uint16_t stats_interval)
-    : config_(config_name),
-      stats_interval_(stats_interval) {}
+static_assert(RTE_MAX_ETHPORTS <= 64, "Pending output ports are tracked in 64-bit mask");
+
+PacketManager::PacketManager(const CmdArgs &cmd_args)
+    : config_(cmd_args.config_file),
+      port_manager_(cmd_args),
+      stats_interval_(cmd_args.stats_interval),
+      parse_tunnels_(cmd_args.parse_tunnels),
+      adaptive_poll_(cmd_args.adaptive_poll),
+      top_talkers_(cmd_args.top_talkers),
+      cardinality_(cmd_args.cardinality),
+      flow_exporter_(cmd_args.ipfix_port ? new FlowExporter(cmd_args.ipfix_addr, cmd_args.ipfix_port) : nullptr),
+      flow_table_size_(cmd_args.flow_table_size) {
+  memset(&heavy_hitters_, 0, sizeof(heavy_hitters_));
+  memset(&cardinalities_, 0, sizeof(cardinalities_));
+  memset(&flow_tables_, 0, sizeof(flow_tables_));
+  memset(&tx_pending_, 0, sizeof(tx_pending_));
+}
+
+PacketManager::~PacketManager() {
+  for (auto heavy_hitters : heavy_hitters_) {
+    delete heavy_hitters;
+  }
+  for (auto cardinality : cardinalities_) {
+    delete cardinality;
+  }
+  for (auto flow_table : flow_tables_) {
+    if (flow_table) {
+      flow_table->~FlowTable();
+      rte_free(flow_table);
+    }
+  }
+}
 
 bool PacketManager::Initialize() {
   if (!config_.Initialize()) {
@@ -23,6 +64,37 @@ bool PacketManager::Initialize() {
     return false;
   }
 
+  if (flow_exporter_) {
+    if (!flow_exporter_->Initialize()) {
+      return false;
+    }
+    const uint64_t tsc_hz = rte_get_tsc_hz();
+    auto nb_ports = rte_eth_dev_count();
+    for (uint8_t i = 0; i < nb_ports; ++i) {
+      // Producer and consumer indexes are on separate cache lines, operator new doesn't align them
+      void *mem = rte_zmalloc_socket("flow_table", sizeof(FlowTable), CACHE_LINE_SIZE, rte_eth_dev_socket_id(i));
+      if (!mem) {
+        LOG(ERROR) << "Can't allocate flow table for port " << (uint16_t)i;
+        return false;
+      }
+      flow_tables_[i] = new (mem) FlowTable(i, flow_table_size_, tsc_hz * kFLOW_IDLE_TIMEOUT_S,
+                                            tsc_hz * kFLOW_ACTIVE_TIMEOUT_S);
+    }
+  }
+
+  // Top talkers and cardinalities are shown with statistics only
+  if (stats_interval_ > 0) {
+    auto nb_ports = rte_eth_dev_count();
+    for (uint8_t i = 0; i < nb_ports; ++i) {
+      if (top_talkers_) {
+        heavy_hitters_[i] = new HeavyHitters;
+      }
+      if (cardinality_) {
+        cardinalities_[i] = new Cardinality;
+      }
+    }
+  }
+
   return true;
 }
 
@@ -30,8 +102,9 @@ void PacketManager::RunProcessing() {
   static constexpr uint64_t timer_period = kTIMER_MILLISECOND * 100;
   static const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S * kBURST_TX_DRAIN_US;
   static const uint64_t stats_interval_tsc = stats_interval_ * 1000 *kTIMER_MILLISECOND;
-  uint64_t prev_tsc = rte_rdtsc(), cur_tsc, diff_tsc, timer_tsc = 0, timer_stats_tsc = 0;
-  rte_eth_link link;
+  uint64_t prev_tsc = rte_rdtsc(), cur_tsc, diff_tsc, timer_tsc = 0, timer_stats_tsc = 0, timer_window_tsc = 0;
+  bool woken_up = false;   // the previous iteration waited for rx interrupt
+  rte_eth_link link{};
 
   auto lcore_id = rte_lcore_id();
   auto port = port_manager_.GetPortByCore(lcore_id);
@@ -41,29 +114,49 @@ void PacketManager::RunProcessing() {
   }
   auto port_id = port->GetPortId();
   PortQueue rx_queue;
+  FragmentTable fragment_table(rte_get_tsc_hz() / MS_PER_S * kFRAGMENT_TIMEOUT_MS);
   auto lcore_stats_id = port_manager_.GetStatsLcoreId();
-  auto nb_ports = rte_eth_dev_count();
+  IdlePoller idle_poller(adaptive_poll_ && port->EnableRxInterrupt());
+  rte_eth_link_get_nowait(port_id, &link);
+  port->SetLinkUp(link.link_status);
+  qsbr_.Online(lcore_id);
   LOG(INFO) << "Processing at lcore_id=" << (uint16_t)lcore_id << " started";
 
   while(!terminated.load(std::memory_order_relaxed)) {
     cur_tsc = rte_rdtsc();
     diff_tsc = cur_tsc - prev_tsc;
     if (diff_tsc >= drain_tsc) {
-      // Flush port tx-queues
-      for (uint8_t i = 0; i < nb_ports; ++i) {
-        auto port_i = port_manager_.GetPortByIndex(i);
-        auto tx_queue_i = port_manager_.GetPortTxQueue(lcore_id, i);
-        port_i->SendAllPackets(tx_queue_i);
+      FlushTxQueues(lcore_id);
+      if (flow_tables_[port_id]) {
+        flow_tables_[port_id]->Expire(cur_tsc);
       }
       prev_tsc = cur_tsc;
 
       timer_tsc += diff_tsc;
-      // Update port link status
+      // Update port link status, it's shared with lcores which output to the port
       if (timer_tsc >= timer_period) {
         rte_eth_link_get_nowait(port->GetPortId(), &link);
+        if ((bool)link.link_status != port->IsLinkUp()) {
+          LOG(INFO) << "Port " << (uint16_t)port_id << " link is " << (link.link_status ? "up" : "down");
+          port->SetLinkUp(link.link_status);
+        }
         timer_tsc = 0;
       }
 
+      // Top talkers and cardinalities are counted in windows of statistics interval
+      if (stats_interval_tsc > 0) {
+        timer_window_tsc += diff_tsc;
+        if (timer_window_tsc > stats_interval_tsc) {
+          if (heavy_hitters_[port_id]) {
+            heavy_hitters_[port_id]->Publish();
+          }
+          if (cardinalities_[port_id]) {
+            cardinalities_[port_id]->Publish();
+          }
+          timer_window_tsc = 0;
+        }
+      }
+
       // Print statistics
       if (stats_interval_tsc > 0) {
         if (lcore_id == lcore_stats_id) {
@@ -76,75 +169,402 @@ void PacketManager::RunProcessing() {
       }
     }
 
-    // TODO: print info about link status changing
-
     // Read packets from port rx-queue
+    uint16_t nb_rx = 0;
     if (link.link_status) {
       port->ReceivePackets(&rx_queue);
-      ProcessPackets(&rx_queue, port_id);
+      nb_rx = rx_queue.count_;
+      if (woken_up && nb_rx) {
+        port->UpdateCounter(CNT_IDLE_WAKEUPS, lcore_id);
+      }
+      ProcessPackets(&rx_queue, port_id, fragment_table);
+    }
+
+    woken_up = false;
+
+    // Rules aren't referenced between bursts
+    qsbr_.Quiescent(lcore_id);
+
+    if (adaptive_poll_) {
+      switch (idle_poller.Update(nb_rx)) {
+        case IDLE_POLL:
+          break;
+        case IDLE_PAUSE:
+          rte_pause();
+          break;
+        case IDLE_SLEEP:
+          usleep(kIDLE_SLEEP_US);
+          port->UpdateCounter(CNT_IDLE_SLEEPS, lcore_id);
+          break;
+        case IDLE_WAIT_INTR:
+          // Nothing is left in tx-queues while lcore waits, rules may be reloaded meanwhile
+          FlushTxQueues(lcore_id);
+          qsbr_.Offline(lcore_id);
+          port->WaitRxInterrupt(kIDLE_INTR_TIMEOUT_MS);
+          woken_up = true;
+          qsbr_.Online(lcore_id);
+          port->UpdateCounter(CNT_IDLE_INTR_WAITS, lcore_id);
+          break;
+      }
     }
   }
+  DrainPackets(port, &rx_queue, fragment_table, lcore_id);
+  qsbr_.Offline(lcore_id);
 
   LOG(INFO) << "Processing at lcore_id=" << (uint16_t)lcore_id << " finished";
 }
 
-void PacketManager::ProcessPackets(PortQueue *queue, const uint8_t port_id) {
+// Returns true if all packets of lcore were accepted by NIC, only ports which
+// the lcore has output to since they were flushed are visited
+bool PacketManager::FlushTxQueues(const unsigned lcore_id) {
+  uint64_t pending = tx_pending_[lcore_id].ports;
+  while (pending) {
+    const uint8_t i = __builtin_ctzll(pending);
+    pending &= pending - 1;
+    auto port_i = port_manager_.GetPortByIndex(i);
+    auto tx_queue_i = port_manager_.GetPortTxQueue(lcore_id, i);
+    auto tx_ring_i = port_manager_.GetPortTxRing(lcore_id, i);
+    port_i->SendAllPackets(tx_queue_i, tx_ring_i);
+    bool flushed = tx_ring_i->Count() == 0;
+    auto scheduler_i = port_manager_.GetScheduler(lcore_id, i);
+    if (scheduler_i) {
+      port_i->SendScheduledPackets(scheduler_i);
+      flushed &= scheduler_i->Count() == 0 && scheduler_i->GetPending()->count_ == 0;
+    }
+    if (flushed) {
+      tx_pending_[lcore_id].ports &= ~(1ULL << i);
+    }
+  }
+
+  return tx_pending_[lcore_id].ports == 0;
+}
+
+void PacketManager::DrainPackets(PortBase *port, PortQueue *rx_queue, FragmentTable &fragment_table,
+                                 const unsigned lcore_id) {
+  const uint64_t start_tsc = rte_rdtsc();
+  const uint64_t timeout_tsc = rte_get_tsc_hz() / MS_PER_S * kSHUTDOWN_TIMEOUT_MS;
+
+  // Packets which are already in rx-queue are processed (peer may still send, so it's limited by time)
+  do {
+    port->ReceivePackets(rx_queue);
+    ProcessPackets(rx_queue, port->GetPortId(), fragment_table);
+  } while (rx_queue->count_ > 0 && rte_rdtsc() - start_tsc < timeout_tsc);
+
+  if (flow_tables_[port->GetPortId()]) {
+    flow_tables_[port->GetPortId()]->ExpireAll();
+  }
+
+  // Output ports may be busy, the rest is freed with tx-rings
+  while (!FlushTxQueues(lcore_id)) {
+    if (rte_rdtsc() - start_tsc >= timeout_tsc) {
+      LOG(WARNING) << "Not all packets were sent by lcore_id=" << (uint16_t)lcore_id;
+      break;
+    }
+  }
+}
+
+// Called after all processing lcores finished
+void PacketManager::Shutdown() {
+  ExportFlows();
+  PacketCapture::Instance().Close();
+  SlowPath::Instance().Close();
+  PrintStats();
+  port_manager_.Shutdown();
+}
+
+// Called at master lcore, records are sent in batches
+void PacketManager::ExportFlows() {
+  if (!flow_exporter_) {
+    return;
+  }
+  FlowRecord records[kFLOW_EXPORT_BURST];
+  for (auto flow_table : flow_tables_) {
+    if (!flow_table) {
+      continue;
+    }
+    uint32_t n;
+    while ((n = flow_table->Dequeue(records, kFLOW_EXPORT_BURST)) > 0) {
+      flow_exporter_->Export(records, n);
+    }
+  }
+  flow_exporter_->Flush();
+}
+
+bool PacketManager::ReloadConfig() {
+  return config_.Reload(qsbr_);
+}
+
+void PacketManager::ProcessPackets(PortQueue *queue, const uint8_t port_id, FragmentTable &fragment_table) {
   PacketAnalyzer &analyzer = PacketAnalyzer::Instance();
   auto lcore_id = rte_lcore_id();
   auto port = port_manager_.GetPortByIndex(port_id);
+  uint8_t prepare_flags = 0;
+  prepare_flags |= port->GetPtypeOffload() ? PREPARE_PTYPE : 0;
+  prepare_flags |= parse_tunnels_ ? PREPARE_TUNNELS : 0;
+  HeavyHitters *heavy_hitters = heavy_hitters_[port_id];
+  Cardinality *cardinality = cardinalities_[port_id];
+  FlowTable *flow_table = flow_tables_[port_id];
+  const RuleTable *rules = config_.GetRules();
+  const bool need_flow_keys = heavy_hitters || cardinality || flow_table || rules->HasFlowSampling();
+
+  AclKey keys[kMAX_PKTS_IN_QUEUE];
+  const uint8_t *keys_data[kMAX_PKTS_IN_QUEUE];
+  uint32_t results[kMAX_PKTS_IN_QUEUE];
+  rte_mbuf *pkts[kMAX_PKTS_IN_QUEUE];
+  protocol_type protocols[kMAX_PKTS_IN_QUEUE];
+  FlowKey flow_keys[kMAX_PKTS_IN_QUEUE];
+  uint32_t flow_hashes[kMAX_PKTS_IN_QUEUE];
+  bool flow_keys_valid[kMAX_PKTS_IN_QUEUE];
+  uint16_t nb_pkts = 0;
 
   for (uint16_t i = 0; i < queue->count_; ++i) {
     DLOG(INFO) << "Process single packet from port_id=" << (uint16_t)port_id;
     auto m = queue->queue_[i];
-    if (packet_modifier::PreparePacket(m)) {
-      DLOG(INFO) << "L2_len=" << m->l2_len;
-      DLOG(INFO) << "L3_len=" << m->l3_len;
-      DLOG(INFO) << "L4_len=" << m->l4_len;
-
-      protocol_type protocol = analyzer.Analyze(m);
-      port->UpdateProtocolStats(protocol, lcore_id);
-      const uint16_t rule_key = port_id | (protocol << 8);
-      Actions *actions;
-      config_.GetActions(rule_key , actions);
+    if (!packet_modifier::PreparePacket(m, prepare_flags)) {
+      rte_pktmbuf_free(m);
+      continue;
+    }
+    if (m->outer_l2_len) {
+      UpdateTunnelStats(m, port, lcore_id);
+    }
+    if ((m->packet_type & RTE_PTYPE_L3_MASK) == RTE_PTYPE_L3_IPV6_EXT) {
+      port->UpdateCounter(CNT_IPV6_EXT_HDRS, lcore_id);
+    }
+    DLOG(INFO) << "L2_len=" << m->l2_len;
+    DLOG(INFO) << "L3_len=" << m->l3_len;
+    DLOG(INFO) << "L4_len=" << m->l4_len;
 
-      if (!actions) {
-        continue;
+    protocol_type protocol;
+    if ((m->packet_type & RTE_PTYPE_L4_MASK) == RTE_PTYPE_L4_FRAG) {
+      protocol = AnalyzeFragment(m, fragment_table, port, lcore_id);
+    }
+    else {
+      protocol = analyzer.Analyze(m);
+    }
+    port->UpdateProtocolStats(protocol, lcore_id);
+    FlowKey &flow_key = flow_keys[nb_pkts];
+    flow_keys_valid[nb_pkts] = need_flow_keys && GetFlowKey(m, flow_key);
+    if (flow_keys_valid[nb_pkts]) {
+      flow_hashes[nb_pkts] = GetFlowHash(flow_key);
+      if (heavy_hitters) {
+        heavy_hitters->Update(flow_key, flow_hashes[nb_pkts], protocol, m->pkt_len);
+      }
+      if (cardinality) {
+        cardinality->Update(protocol, flow_hashes[nb_pkts],
+                            rte_jhash(flow_key.src_addr, sizeof(flow_key.src_addr), 0));
       }
+    }
 
-      for (auto it = actions->cbegin(); it != actions->cend(); ++it) {
-        switch ((*it)->type) {
-          case DROP: {
-             break;
-          }
-          case PUSH_VLAN: {
-            auto vlan_data = reinterpret_cast<PushVlanAction*>(*it);
-            packet_modifier::ExecutePushVlan(m, vlan_data->vlan_tag);
-            break;
-          }
-          case PUSH_MPLS: {
-            auto mpls_data = reinterpret_cast<PushMplsAction*>(*it);
-            packet_modifier::ExecutePushMpls(m, mpls_data->mpls_label);
-            break;
-          }
-          case OUTPUT: {
-            auto output_data = reinterpret_cast<OutputAction*>(*it);
-            rte_mbuf *m_copy = port_manager_.CopyMbuf(m);
-            this->ExecuteOutput(m_copy, output_data->port_id);
-            break;
-          }
+    FillAclKey(m, port_id, protocol, keys[nb_pkts]);
+    keys_data[nb_pkts] = (const uint8_t *)&keys[nb_pkts];
+    protocols[nb_pkts] = protocol;
+    pkts[nb_pkts++] = m;
+  }
+
+  // Rules are matched for the whole burst at once
+  rules->Classify(keys_data, results, nb_pkts);
+  const uint64_t cur_tsc = rte_rdtsc();
+  for (uint16_t i = 0; i < nb_pkts; ++i) {
+    // Flow is accounted before actions modify packet
+    if (flow_table && flow_keys_valid[i]) {
+      flow_table->Update(flow_keys[i], flow_hashes[i], protocols[i], results[i], pkts[i]->pkt_len, cur_tsc);
+    }
+    const Actions *actions = rules->GetActions(results[i]);
+    if (actions) {
+      ExecuteActions(pkts[i], protocols[i], flow_keys_valid[i] ? &flow_hashes[i] : nullptr, actions, port,
+                     lcore_id, cur_tsc);
+    }
+    rte_pktmbuf_free(pkts[i]);
+  }
+
+  queue->count_ = 0;
+}
+
+// flow_hash is hash of flow key taken before actions modify packet, nullptr if packet has no flow key
+void PacketManager::ExecuteActions(rte_mbuf *m, const protocol_type protocol, const uint32_t *flow_hash,
+                                   const Actions *actions, PortBase *port, const unsigned lcore_id,
+                                   const uint64_t cur_tsc) {
+  for (auto it = actions->cbegin(); it != actions->cend(); ++it) {
+    switch ((*it)->type) {
+      case DROP: {
+         break;
+      }
+      case METER: {
+        // Packet exceeding the rate is dropped, the rest actions are skipped
+        auto meter_data = reinterpret_cast<MeterAction*>(*it);
+        if (!meter_data->meter->Conform(lcore_id, m->pkt_len, cur_tsc)) {
+          port->UpdateCounter(CNT_METER_DROPS, lcore_id);
+          return;
+        }
+        break;
+      }
+      case PUSH_VLAN: {
+        auto vlan_data = reinterpret_cast<PushVlanAction*>(*it);
+        packet_modifier::ExecutePushVlan(m, vlan_data->vlan_tag);
+        break;
+      }
+      case PUSH_MPLS: {
+        auto mpls_data = reinterpret_cast<PushMplsAction*>(*it);
+        packet_modifier::ExecutePushMpls(m, mpls_data->mpls_label);
+        break;
+      }
+      case POP_VLAN: {
+        packet_modifier::ExecutePopVlan(m);
+        break;
+      }
+      case POP_MPLS: {
+        packet_modifier::ExecutePopMpls(m);
+        break;
+      }
+      case SET_DSCP: {
+        auto dscp_data = reinterpret_cast<SetDscpAction*>(*it);
+        packet_modifier::ExecuteSetDscp(m, dscp_data->dscp);
+        break;
+      }
+      case DEC_TTL: {
+        // Packet with expired TTL is dropped, the rest actions are skipped
+        if (!packet_modifier::ExecuteDecTtl(m)) {
+          port->UpdateCounter(CNT_TTL_DROPS, lcore_id);
+          return;
+        }
+        break;
+      }
+      case SET_ETH_DST: {
+        auto eth_data = reinterpret_cast<SetEthAction*>(*it);
+        packet_modifier::ExecuteSetEthDst(m, eth_data->addr);
+        break;
+      }
+      case SET_ETH_SRC: {
+        auto eth_data = reinterpret_cast<SetEthAction*>(*it);
+        packet_modifier::ExecuteSetEthSrc(m, eth_data->addr);
+        break;
+      }
+      case OUTPUT: {
+        auto output_data = reinterpret_cast<OutputAction*>(*it);
+        rte_mbuf *m_copy = port_manager_.CopyMbuf(m, output_data->port_id);
+        this->ExecuteOutput(m_copy, output_data->port_id, protocol);
+        break;
+      }
+      case OUTPUT_GROUP: {
+        // Both directions of flow go to the same port while its link is up
+        auto group_data = reinterpret_cast<OutputGroupAction*>(*it);
+        bool link_up[kMAX_GROUP_PORTS];
+        for (uint8_t i = 0; i < group_data->nb_ports; ++i) {
+          link_up[i] = port_manager_.GetPortByIndex(group_data->port_ids[i])->IsLinkUp();
+        }
+        const int index = SelectGroupPort(group_data->port_ids, link_up, group_data->nb_ports,
+                                          GetSymmetricFlowHash(m));
+        if (index < 0) {
+          port->UpdateCounter(CNT_GROUP_DROPS, lcore_id);
+          break;
+        }
+        const uint8_t output_port_id = group_data->port_ids[index];
+        rte_mbuf *m_copy = port_manager_.CopyMbuf(m, output_port_id);
+        this->ExecuteOutput(m_copy, output_port_id, protocol);
+        break;
+      }
+      case CAPTURE: {
+        // It's the last action, so captured packet is the one which is sent
+        auto capture_data = reinterpret_cast<CaptureAction*>(*it);
+        if (!PacketCapture::Instance().Enqueue(capture_data->capture_id, m, cur_tsc)) {
+          port->UpdateCounter(CNT_CAPTURE_DROPS, lcore_id);
+        }
+        break;
+      }
+      case MIRROR: {
+        // Clone shares data with the packet, it's the last action so the data isn't modified
+        auto mirror_data = reinterpret_cast<MirrorAction*>(*it);
+        rte_mbuf *m_clone = port_manager_.CloneMbuf(m);
+        if (m_clone && mirror_data->truncate_len) {
+          packet_modifier::ExecuteTruncate(m_clone, mirror_data->truncate_len);
+        }
+        this->ExecuteOutput(m_clone, mirror_data->port_id, protocol);
+        break;
+      }
+      case SAMPLE: {
+        // Clone of sampled packet is analyzed at master lcore
+        auto sample_data = reinterpret_cast<SampleAction*>(*it);
+        if (SamplePacket(flow_hash, sample_data->rate, sample_data->by_flow) &&
+            !SlowPath::Instance().Enqueue(m, protocol)) {
+          port->UpdateCounter(CNT_SAMPLE_DROPS, lcore_id);
         }
+        break;
       }
     }
-    rte_pktmbuf_free(m);
   }
+}
 
-  queue->count_ = 0;
+void PacketManager::UpdateTunnelStats(const rte_mbuf *m, PortBase *port, const unsigned lcore_id) {
+  switch (m->packet_type & RTE_PTYPE_TUNNEL_MASK) {
+    case RTE_PTYPE_TUNNEL_GRE: {
+      port->UpdateCounter(CNT_TUNNEL_GRE, lcore_id);
+      break;
+    }
+    case RTE_PTYPE_TUNNEL_VXLAN: {
+      port->UpdateCounter(CNT_TUNNEL_VXLAN, lcore_id);
+      break;
+    }
+    case RTE_PTYPE_TUNNEL_GTPU: {
+      port->UpdateCounter(CNT_TUNNEL_GTPU, lcore_id);
+      break;
+    }
+    default: {
+      // Other tunnels (reported by NIC) aren't counted
+      break;
+    }
+  }
 }
 
-void PacketManager::ExecuteOutput(rte_mbuf *m, const uint8_t port_id) {
+protocol_type PacketManager::AnalyzeFragment(rte_mbuf *m, FragmentTable &fragment_table, PortBase *port,
+                                             const unsigned lcore_id) {
+  FragmentKey key;
+  bool first;
+  protocol_type protocol = UNKNOWN;
+  if (!GetFragmentKey(m, key, first)) {
+    port->UpdateCounter(CNT_FRAGS_UNMATCHED, lcore_id);
+    return protocol;
+  }
+
+  // First fragment is analyzed as usual, the rest ones get its result
+  if (first) {
+    protocol = PacketAnalyzer::Instance().Analyze(m);
+    fragment_table.Add(key, protocol, rte_rdtsc());
+    port->UpdateCounter(CNT_FRAGS_FIRST, lcore_id);
+  }
+  else if (fragment_table.Lookup(key, rte_rdtsc(), protocol)) {
+    port->UpdateCounter(CNT_FRAGS_MATCHED, lcore_id);
+  }
+  else {
+    port->UpdateCounter(CNT_FRAGS_UNMATCHED, lcore_id);
+  }
+
+  return protocol;
+}
+
+void PacketManager::ExecuteOutput(rte_mbuf *m, const uint8_t port_id, const protocol_type protocol) {
+  if (!m) {
+    return;
+  }
+
+  auto lcore_id = rte_lcore_id();
   auto port = port_manager_.GetPortByIndex(port_id);
-  auto tx_queue = port_manager_.GetPortTxQueue(rte_lcore_id(), port_id);
-  port->SendOnePacket(m, tx_queue);
+  auto scheduler = port_manager_.GetScheduler(lcore_id, port_id);
+  tx_pending_[lcore_id].ports |= 1ULL << port_id;
+  if (scheduler) {
+    if (!scheduler->Enqueue(m, protocol)) {
+      port->UpdateCounter(CNT_SCHED_DROPS, lcore_id);
+      rte_pktmbuf_free(m);
+      return;
+    }
+    if (scheduler->Count() >= port->GetBurstSize()) {
+      port->SendScheduledPackets(scheduler);
+    }
+    return;
+  }
+
+  auto tx_queue = port_manager_.GetPortTxQueue(lcore_id, port_id);
+  auto tx_ring = port_manager_.GetPortTxRing(lcore_id, port_id);
+  port->SendOnePacket(m, tx_queue, tx_ring);
 }
 
 void PacketManager::PrintStats() const {
@@ -164,8 +584,58 @@ void PacketManager::PrintStats() const {
     os << "     SIP: " << port->GetProtocolStats(SIP) << "\n";
     os << "     RTP: " << port->GetProtocolStats(RTP) << "\n";
     os << "     RTSP: " << port->GetProtocolStats(RTSP) << "\n";
+    if (parse_tunnels_) {
+      os << " - Tunnels:\n";
+      os << "     GRE: " << port->GetCounter(CNT_TUNNEL_GRE) << "\n";
+      os << "     VXLAN: " << port->GetCounter(CNT_TUNNEL_VXLAN) << "\n";
+      os << "     GTP-U: " << port->GetCounter(CNT_TUNNEL_GTPU) << "\n";
+    }
+    os << " - Meter drops: " << port->GetCounter(CNT_METER_DROPS) << "\n";
+    os << " - Scheduler drops: " << port->GetCounter(CNT_SCHED_DROPS) << "\n";
+    os << " - TX deferred: " << port->GetCounter(CNT_TX_DEFERRED) << "\n";
+    os << " - TX drops: " << port->GetCounter(CNT_TX_DROPS) << "\n";
+    os << " - Capture drops: " << port->GetCounter(CNT_CAPTURE_DROPS) << "\n";
+    os << " - Sample drops: " << port->GetCounter(CNT_SAMPLE_DROPS) << "\n";
+    os << " - TTL expired drops: " << port->GetCounter(CNT_TTL_DROPS) << "\n";
+    os << " - Output group drops (all links down): " << port->GetCounter(CNT_GROUP_DROPS) << "\n";
+    os << " - Idle sleeps: " << port->GetCounter(CNT_IDLE_SLEEPS) << "\n";
+    os << " - Idle interrupt waits: " << port->GetCounter(CNT_IDLE_INTR_WAITS) << "\n";
+    os << " - Idle wake-ups by traffic: " << port->GetCounter(CNT_IDLE_WAKEUPS) << "\n";
+    os << " - IPv6 ext. headers: " << port->GetCounter(CNT_IPV6_EXT_HDRS) << "\n";
+    os << " - Fragments:\n";
+    os << "     First: " << port->GetCounter(CNT_FRAGS_FIRST) << "\n";
+    os << "     Matched: " << port->GetCounter(CNT_FRAGS_MATCHED) << "\n";
+    os << "     Unmatched: " << port->GetCounter(CNT_FRAGS_UNMATCHED) << "\n";
+    if (flow_tables_[i]) {
+      os << " - Flow records dropped: " << flow_tables_[i]->GetDrops() << "\n";
+      os << " - Flows evicted from full buckets: " << flow_tables_[i]->GetEvictions() << "\n";
+    }
+    if (cardinalities_[i]) {
+      uint64_t flows[kCARDINALITY_PROTOCOLS], clients[kCARDINALITY_PROTOCOLS];
+      cardinalities_[i]->GetPublished(flows, clients);
+      os << " - Distinct flows/sources:\n";
+      for (uint8_t j = 0; j < kCARDINALITY_PROTOCOLS; ++j) {
+        os << "     " << GetProtocolName((protocol_type)j) << ": " << flows[j] << "/" << clients[j] << "\n";
+      }
+    }
+    if (heavy_hitters_[i]) {
+      TopFlows top;
+      heavy_hitters_[i]->GetPublished(top);
+      os << " - Top talkers (bytes):\n";
+      for (uint8_t j = 0; j < kTOP_PROTOCOLS; ++j) {
+        if (top.count[j] == 0) continue;
+        os << "     " << GetProtocolName((protocol_type)j) << ":\n";
+        for (uint8_t k = 0; k < top.count[j]; ++k) {
+          os << "       " << FlowKeyToString(top.flows[j][k].key) << ": " << top.flows[j][k].bytes << "\n";
+        }
+      }
+    }
   }
 
+  if (flow_exporter_) {
+    os << "Flow records exported: " << flow_exporter_->GetExported() << "\n";
+  }
+  os << SlowPath::Instance().GetStats();
   os << "====================\n";
   LOG(INFO) << os.str();
 }
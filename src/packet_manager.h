@@ -1,13 +1,20 @@
 #ifndef PACKET_MANAGER_
 #define PACKET_MANAGER_
 
+#include <memory>
 #include "port_manager.h"
 #include "config.h"
+#include "cmd_args.h"
+#include "fragment_table.h"
+#include "idle_poller.h"
+#include "heavy_hitters.h"
+#include "hyperloglog.h"
+#include "flow_exporter.h"
 
 class PacketManager {
  public:
-  PacketManager(const std::string &, const uint16_t);
-  ~PacketManager() = default;
+  explicit PacketManager(const CmdArgs &);
+  ~PacketManager();
 
   PacketManager(const PacketManager &) = delete;
   PacketManager &operator=(const PacketManager &) = delete;
@@ -16,17 +23,42 @@ class PacketManager {
 
   bool Initialize();
   void RunProcessing();
+  bool ReloadConfig();
+  void Shutdown();
+  void ExportFlows();
 
  protected:
-  void ProcessPackets(PortQueue *, const uint8_t);
-  void ExecuteOutput(rte_mbuf *, const uint8_t);
+  bool FlushTxQueues(const unsigned);
+  void DrainPackets(PortBase *, PortQueue *, FragmentTable &, const unsigned);
+  void ProcessPackets(PortQueue *, const uint8_t, FragmentTable &);
+  void UpdateTunnelStats(const rte_mbuf *, PortBase *, const unsigned);
+  protocol_type AnalyzeFragment(rte_mbuf *, FragmentTable &, PortBase *, const unsigned);
+  void ExecuteActions(rte_mbuf *, const protocol_type, const uint32_t *, const Actions *, PortBase *,
+                      const unsigned, const uint64_t);
+  void ExecuteOutput(rte_mbuf *, const uint8_t, const protocol_type);
 
   void PrintStats() const;
 
  private:
   Config config_;
+  Qsbr qsbr_;
   PortManager port_manager_;
   uint16_t stats_interval_;
+  bool parse_tunnels_;
+  bool adaptive_poll_;
+  bool top_talkers_;
+  bool cardinality_;
+  HeavyHitters *heavy_hitters_[RTE_MAX_ETHPORTS]; // nullptr - top talkers aren't tracked
+  Cardinality *cardinalities_[RTE_MAX_ETHPORTS];  // nullptr - distinct flows aren't counted
+  std::unique_ptr<FlowExporter> flow_exporter_;   // nullptr - flows aren't exported
+  uint32_t flow_table_size_;
+  FlowTable *flow_tables_[RTE_MAX_ETHPORTS];
+
+  // Bit per output port which has packets in tx-queue, tx-ring or scheduler of lcore
+  struct TxPending {
+    uint64_t ports;
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+  TxPending tx_pending_[RTE_MAX_LCORE];
 };
 
 #endif // PACKET_MANAGER_
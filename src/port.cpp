@@ -1,14 +1,52 @@
+#include <glog/logging.h>
 #include "port.h"
 #include <rte_ethdev.h>
+#include <rte_lcore.h>
+#include <rte_interrupts.h>
+#include "scheduler.h"
 
-PortBase::PortBase(const uint8_t port_id) : port_id_(port_id) {
+PortBase::PortBase(const uint8_t port_id) : port_id_(port_id), ptype_offload_(false), tx_retries_(0),
+                                                burst_size_(kMAX_PKTS_IN_QUEUE), link_up_(false) {
   memset(&protocol_stats_, 0, sizeof(protocol_stats_));
+  memset(&counters_, 0, sizeof(counters_));
 }
 
 uint8_t PortBase::GetPortId() const {
   return port_id_;
 }
 
+void PortBase::SetPtypeOffload(const bool ptype_offload) {
+  ptype_offload_ = ptype_offload;
+}
+
+bool PortBase::GetPtypeOffload() const {
+  return ptype_offload_;
+}
+
+void PortBase::SetTxRetries(const uint16_t tx_retries) {
+  tx_retries_ = tx_retries;
+}
+
+uint16_t PortBase::GetTxRetries() const {
+  return tx_retries_;
+}
+
+void PortBase::SetBurstSize(const uint16_t burst_size) {
+  burst_size_ = burst_size;
+}
+
+uint16_t PortBase::GetBurstSize() const {
+  return burst_size_;
+}
+
+void PortBase::SetLinkUp(const bool link_up) {
+  link_up_.store(link_up, std::memory_order_relaxed);
+}
+
+bool PortBase::IsLinkUp() const {
+  return link_up_.load(std::memory_order_relaxed);
+}
+
 void PortBase::UpdateProtocolStats(const protocol_type protocol, const unsigned lcore_id) {
   switch (protocol) {
     case HTTP: {
@@ -39,25 +77,25 @@ uint64_t PortBase::GetProtocolStats(const protocol_type protocol) const {
 
   switch (protocol) {
     case HTTP: {
-      for (uint8_t i = 0; i < kMAX_LCORES; ++i) {
+      for (unsigned i = 0; i < RTE_MAX_LCORE; ++i) {
         ret += protocol_stats_[i].http.load(std::memory_order_relaxed);
       }
       break;
     }
     case SIP: {
-      for (uint8_t i = 0; i < kMAX_LCORES; ++i) {
+      for (unsigned i = 0; i < RTE_MAX_LCORE; ++i) {
         ret += protocol_stats_[i].sip.load(std::memory_order_relaxed);
       }
       break;
     }
     case RTP: {
-      for (uint8_t i = 0; i < kMAX_LCORES; ++i) {
+      for (unsigned i = 0; i < RTE_MAX_LCORE; ++i) {
         ret += protocol_stats_[i].rtp.load(std::memory_order_relaxed);
       }
       break;
     }
     case RTSP: {
-      for (uint8_t i = 0; i < kMAX_LCORES; ++i) {
+      for (unsigned i = 0; i < RTE_MAX_LCORE; ++i) {
         ret += protocol_stats_[i].rtsp.load(std::memory_order_relaxed);
       }
       break;
@@ -71,41 +109,131 @@ uint64_t PortBase::GetProtocolStats(const protocol_type protocol) const {
   return ret;
 }
 
+void PortBase::UpdateCounter(const port_counter counter, const unsigned lcore_id, const uint64_t value) {
+  counters_[lcore_id].values[counter].fetch_add(value, std::memory_order_relaxed);
+}
+
+uint64_t PortBase::GetCounter(const port_counter counter) const {
+  uint64_t ret = 0;
+
+  for (unsigned i = 0; i < RTE_MAX_LCORE; ++i) {
+    ret += counters_[i].values[counter].load(std::memory_order_relaxed);
+  }
+
+  return ret;
+}
+
 
 PortEthernet::PortEthernet(const uint8_t port_id) : PortBase(port_id) {
 }
 
-void PortEthernet::SendOnePacket(rte_mbuf *m, PortQueue *queue) {
+void PortEthernet::SendOnePacket(rte_mbuf *m, PortQueue *queue, TxRing *ring) {
   queue->queue_[queue->count_++] = m;
 
-  if (queue->count_ == kMAX_PKTS_IN_QUEUE) {
-    SendAllPackets(queue);
+  if (queue->count_ == GetBurstSize()) {
+    SendAllPackets(queue, ring);
   }
 }
 
-void PortEthernet::SendAllPackets(PortQueue *queue) {
-  if (queue->count_ == 0) {
+void PortEthernet::SendAllPackets(PortQueue *queue, TxRing *ring) {
+  if (queue->count_ == 0 && ring->Count() == 0) {
     return;
   }
 
-  uint16_t sended = 0;
-  while (sended != queue->count_) {
-    auto ret = rte_eth_tx_burst(GetPortId(), 0, queue->queue_ + sended, queue->count_ - sended);
-    if (ret == 0) {
+  // Each retry is an attempt to send after NIC didn't accept all packets
+  uint16_t retries = GetTxRetries();
+  while (ring->Count() > 0) {
+    const uint32_t head = ring->head_ & (kTX_RING_SIZE - 1);
+    const uint16_t nb_pkts = RTE_MIN(RTE_MIN(ring->Count(), kTX_RING_SIZE - head), (uint32_t)GetBurstSize());
+    auto ret = TxBurst(ring->ring_ + head, nb_pkts);
+    ring->head_ += ret;
+    if (ret < nb_pkts && retries-- == 0) {
       break;
     }
-    sended += ret;
   }
 
+  uint16_t sended = 0;
+  if (ring->Count() == 0) {
+    while (sended != queue->count_) {
+      auto ret = TxBurst(queue->queue_ + sended, queue->count_ - sended);
+      sended += ret;
+      if (sended != queue->count_ && retries-- == 0) {
+        break;
+      }
+    }
+  }
+
+  // The rest packets wait for free descriptors, they are dropped only if the ring is full
   if (sended < queue->count_) {
-    do {
-      rte_pktmbuf_free(queue->queue_[sended]);
-    } while (++sended < queue->count_);
+    const unsigned lcore_id = rte_lcore_id();
+    const uint16_t nb_deferred = RTE_MIN((uint32_t)(queue->count_ - sended), kTX_RING_SIZE - ring->Count());
+    for (uint16_t i = 0; i < nb_deferred; ++i) {
+      ring->ring_[ring->tail_++ & (kTX_RING_SIZE - 1)] = queue->queue_[sended++];
+    }
+    if (nb_deferred) {
+      UpdateCounter(CNT_TX_DEFERRED, lcore_id, nb_deferred);
+    }
+    if (sended < queue->count_) {
+      UpdateCounter(CNT_TX_DROPS, lcore_id, queue->count_ - sended);
+      do {
+        rte_pktmbuf_free(queue->queue_[sended]);
+      } while (++sended < queue->count_);
+    }
   }
 
   queue->count_ = 0;
 }
 
+uint16_t PortEthernet::TxBurst(rte_mbuf **pkts, const uint16_t nb_pkts) {
+  return rte_eth_tx_burst(GetPortId(), 0, pkts, nb_pkts);
+}
+
+void PortEthernet::SendScheduledPackets(EgressScheduler *scheduler) {
+  PortQueue *pending = scheduler->GetPending();
+  uint16_t retries = GetTxRetries();
+  for (;;) {
+    if (pending->count_ == 0) {
+      pending->count_ = scheduler->Dequeue(pending->queue_, GetBurstSize());
+      if (pending->count_ == 0) {
+        return;
+      }
+    }
+
+    // The rest packets are kept until NIC has free descriptors
+    auto sended = TxBurst(pending->queue_, pending->count_);
+    if (sended < pending->count_) {
+      pending->count_ -= sended;
+      memmove(pending->queue_, pending->queue_ + sended, pending->count_ * sizeof(rte_mbuf *));
+      if (retries-- == 0) {
+        return;
+      }
+      continue;
+    }
+    pending->count_ = 0;
+  }
+}
+
 void PortEthernet::ReceivePackets(PortQueue *queue) {
-  queue->count_ = rte_eth_rx_burst(GetPortId(), 0, queue->queue_, kMAX_PKTS_IN_QUEUE);
+  queue->count_ = rte_eth_rx_burst(GetPortId(), 0, queue->queue_, GetBurstSize());
+}
+
+// Must be called by lcore which waits for interrupts: queue is added to its epoll instance
+bool PortEthernet::EnableRxInterrupt() {
+  auto ret = rte_eth_dev_rx_intr_ctl_q(GetPortId(), 0, RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_ADD, nullptr);
+  if (ret) {
+    LOG(WARNING) << "Rx interrupts aren't supported by port " << (uint16_t)GetPortId() << ", error=" << ret;
+    return false;
+  }
+
+  return true;
+}
+
+void PortEthernet::WaitRxInterrupt(const int timeout_ms) {
+  rte_eth_dev_rx_intr_enable(GetPortId(), 0);
+  // Packets which came before interrupt was enabled don't raise it
+  if (rte_eth_rx_queue_count(GetPortId(), 0) <= 0) {
+    rte_epoll_event event;
+    rte_epoll_wait(RTE_EPOLL_PER_THREAD, &event, 1, timeout_ms);
+  }
+  rte_eth_dev_rx_intr_disable(GetPortId(), 0);
 }
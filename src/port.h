@@ -4,8 +4,33 @@
 #include <atomic>
 #include "common.h"
 
-static constexpr auto kMAX_PKTS_IN_QUEUE = 32;
-static constexpr auto kMAX_LCORES = 16;
+static constexpr auto kMAX_PKTS_IN_QUEUE = 256; // max burst size
+static constexpr uint32_t kTX_RING_SIZE = 1024; // must be power of 2
+
+// Per-port counters of packet processing events
+enum port_counter: uint8_t {
+  CNT_TUNNEL_GRE,
+  CNT_TUNNEL_VXLAN,
+  CNT_TUNNEL_GTPU,
+  CNT_IPV6_EXT_HDRS,
+  CNT_FRAGS_FIRST,
+  CNT_FRAGS_MATCHED,
+  CNT_FRAGS_UNMATCHED,
+  CNT_METER_DROPS,
+  CNT_SCHED_DROPS,
+  CNT_TX_DEFERRED,
+  CNT_TX_DROPS,
+  CNT_IDLE_SLEEPS,
+  CNT_IDLE_INTR_WAITS,
+  CNT_IDLE_WAKEUPS,        // interrupt waits ended by traffic (not by timeout)
+  CNT_CAPTURE_DROPS,
+  CNT_SAMPLE_DROPS,
+  CNT_TTL_DROPS,
+  CNT_GROUP_DROPS,
+  CNT_NUMBER,
+};
+
+class EgressScheduler;
 
 struct PortQueue {
   PortQueue() : count_(0) {}
@@ -14,6 +39,23 @@ struct PortQueue {
   rte_mbuf *queue_[kMAX_PKTS_IN_QUEUE];
 };
 
+// Packets which weren't accepted by NIC, they are kept across loop iterations
+// and sent before new ones
+struct TxRing {
+  TxRing() : head_(0), tail_(0) {}
+  ~TxRing() {
+    while (head_ != tail_) {
+      rte_pktmbuf_free(ring_[head_++ & (kTX_RING_SIZE - 1)]);
+    }
+  }
+
+  uint32_t Count() const { return tail_ - head_; }
+
+  uint32_t head_;
+  uint32_t tail_;
+  rte_mbuf *ring_[kTX_RING_SIZE];
+};
+
 
 class PortBase {
  public:
@@ -25,13 +67,26 @@ class PortBase {
   PortBase(PortBase &&) = delete;
   PortBase &operator=(PortBase &&) = delete;
 
-  virtual void SendOnePacket(rte_mbuf *, PortQueue *) = 0;
-  virtual void SendAllPackets(PortQueue *) = 0;
+  virtual void SendOnePacket(rte_mbuf *, PortQueue *, TxRing *) = 0;
+  virtual void SendAllPackets(PortQueue *, TxRing *) = 0;
+  virtual void SendScheduledPackets(EgressScheduler *) = 0;
   virtual void ReceivePackets(PortQueue *) = 0;
+  virtual bool EnableRxInterrupt() = 0;
+  virtual void WaitRxInterrupt(const int) = 0;
 
   uint8_t GetPortId() const;
+  void SetPtypeOffload(const bool);
+  bool GetPtypeOffload() const;
+  void SetTxRetries(const uint16_t);
+  uint16_t GetTxRetries() const;
+  void SetBurstSize(const uint16_t);
+  uint16_t GetBurstSize() const;
+  void SetLinkUp(const bool);
+  bool IsLinkUp() const;
   void UpdateProtocolStats(const protocol_type, const unsigned);
   uint64_t GetProtocolStats(const protocol_type) const;
+  void UpdateCounter(const port_counter, const unsigned, const uint64_t = 1);
+  uint64_t GetCounter(const port_counter) const;
 
  private:
   struct ProtocolStats {
@@ -41,8 +96,17 @@ class PortBase {
     std::atomic<uint64_t> rtsp;
   } __attribute__((aligned(CACHE_LINE_SIZE)));
 
+  struct Counters {
+    std::atomic<uint64_t> values[CNT_NUMBER];
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
   uint8_t port_id_;
-  ProtocolStats protocol_stats_[kMAX_LCORES];
+  bool ptype_offload_;
+  uint16_t tx_retries_;
+  uint16_t burst_size_;
+  std::atomic<bool> link_up_;   // updated by polling lcore, read by any lcore
+  ProtocolStats protocol_stats_[RTE_MAX_LCORE];  // lcore->stats, any lcore may poll the port
+  Counters counters_[RTE_MAX_LCORE];
 };
 
 
@@ -56,9 +120,16 @@ class PortEthernet : public PortBase {
   PortEthernet (PortEthernet &&) = delete;
   PortEthernet &operator=(PortEthernet &&) = delete;
 
-  virtual void SendOnePacket(rte_mbuf *, PortQueue *) override;
-  virtual void SendAllPackets(PortQueue *) override;
+  virtual void SendOnePacket(rte_mbuf *, PortQueue *, TxRing *) override;
+  virtual void SendAllPackets(PortQueue *, TxRing *) override;
+  virtual void SendScheduledPackets(EgressScheduler *) override;
   virtual void ReceivePackets(PortQueue *) override;
+  virtual bool EnableRxInterrupt() override;
+  virtual void WaitRxInterrupt(const int) override;
+
+ protected:
+  // Hands packets to NIC tx-queue, returns number of accepted ones
+  virtual uint16_t TxBurst(rte_mbuf **, const uint16_t);
 };
 
 #endif // PORT_
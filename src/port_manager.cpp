@@ -1,68 +1,178 @@
 #include <glog/logging.h>
 #include <cassert>
+#include <algorithm>
+#include <sstream>
 #include <rte_cycles.h>
 #include "port_manager.h"
+#include "clone_ring.h"
 
 /* Mempool settings */
 static constexpr auto kMEMPOOL_NAME = "PKT_MEMPOOL";
-static constexpr auto kNB_MBUF = 8192;
-static constexpr auto kCACHE_SIZE = 32;
+static constexpr auto kCLONE_MEMPOOL_NAME = "CLONE_MEMPOOL";
 /* Queues settings */
 static constexpr auto kNB_RX = 1;
 static constexpr auto kNB_TX = 1;
-static constexpr auto kNB_RXD = 128;
-static constexpr auto kNB_TXD = 512;
 
-PortManager::PortManager() : stats_lcore_id_(RTE_MAX_LCORE) {}
+static bool DescriptorsAreValid(const uint16_t nb_desc, const rte_eth_desc_lim &lim) {
+  return nb_desc >= lim.nb_min && nb_desc <= lim.nb_max && (lim.nb_align == 0 || nb_desc % lim.nb_align == 0);
+}
+
+PortManager::PortManager(const CmdArgs &cmd_args)
+    : stats_lcore_id_(RTE_MAX_LCORE),
+      max_pkt_len_(cmd_args.max_pkt_len),
+      egress_sched_(cmd_args.egress_sched),
+      tx_retries_(cmd_args.tx_retries),
+      burst_size_(cmd_args.burst_size),
+      nb_rxd_(cmd_args.nb_rxd),
+      nb_txd_(cmd_args.nb_txd),
+      nb_mbufs_(cmd_args.nb_mbufs),
+      mbuf_cache_(cmd_args.mbuf_cache),
+      mempool_per_port_(cmd_args.mempool_per_port),
+      adaptive_poll_(cmd_args.adaptive_poll),
+      port_lcore_map_(cmd_args.port_lcore_map) {
+  memset(&port_mempools_, 0, sizeof(port_mempools_));
+  memset(&clone_mempools_, 0, sizeof(clone_mempools_));
+  memset(&port_tx_table_, 0, sizeof(port_tx_table_));
+  memset(&tx_rings_, 0, sizeof(tx_rings_));
+  memset(&schedulers_, 0, sizeof(schedulers_));
+}
 
 PortManager::~PortManager() {
+  FreeTxQueues();
   for (auto port : ports_) {
     delete port;
   }
 }
 
+// Ports are stopped before queued packets are returned to mempools, mempools are freed the last
+void PortManager::Shutdown() {
+  for (auto port : ports_) {
+    rte_eth_dev_stop(port->GetPortId());
+  }
+  FreeTxQueues();
+  for (auto port : ports_) {
+    rte_eth_dev_close(port->GetPortId());
+    LOG(INFO) << "Port " << (uint16_t)port->GetPortId() << " closed";
+  }
+  memset(&port_mempools_, 0, sizeof(port_mempools_));
+  memset(&clone_mempools_, 0, sizeof(clone_mempools_));
+  for (auto mp : mempools_) {
+    rte_mempool_free(mp);
+  }
+  mempools_.clear();
+}
+
+void PortManager::FreeTxQueues() {
+  for (auto &lcore_tx_queues : port_tx_table_) {
+    for (auto &tx_queue : lcore_tx_queues) {
+      if (tx_queue) {
+        for (uint16_t i = 0; i < tx_queue->count_; ++i) {
+          rte_pktmbuf_free(tx_queue->queue_[i]);
+        }
+      }
+      delete tx_queue;
+      tx_queue = nullptr;
+    }
+  }
+  for (auto &lcore_tx_rings : tx_rings_) {
+    for (auto &tx_ring : lcore_tx_rings) {
+      delete tx_ring;
+      tx_ring = nullptr;
+    }
+  }
+  for (auto &lcore_schedulers : schedulers_) {
+    for (auto &scheduler : lcore_schedulers) {
+      delete scheduler;
+      scheduler = nullptr;
+    }
+  }
+}
+
 bool PortManager::Initialize() {
   auto nb_ports = rte_eth_dev_count();
   LOG(INFO) << "Number of ports: " << (uint16_t)nb_ports;
 
-  /* Find core for each port.
-   * Create mempool on each socket.
+  /* Find core for each port (on the port's socket if possible).
+   * Create mempool on each socket (or for each port).
    * Initialize each port. */
-  unsigned master_lcore = rte_get_master_lcore();
-  unsigned lcore_id = 0;
-  for (uint8_t i = 0; i < nb_ports; ++i) {
-    while (!rte_lcore_is_enabled(lcore_id) || lcore_id == master_lcore) {
-      lcore_id = rte_get_next_lcore(lcore_id, true, false);
-      if (lcore_id >= RTE_MAX_LCORE) {
-        LOG(ERROR) << "Can't find core for each port";
+  std::vector<unsigned> port_lcores;
+  if (!PlacePorts(nb_ports, port_lcores)) {
+    return false;
+  }
+  std::unordered_map<unsigned, uint8_t> socket_ports; // socket->number of ports
+  for (auto lcore_id : port_lcores) {
+    ++socket_ports[rte_lcore_to_socket_id(lcore_id)];
+  }
+
+  if (mempool_per_port_) {
+    for (uint8_t i = 0; i < nb_ports; ++i) {
+      auto socket_id = rte_lcore_to_socket_id(port_lcores[i]);
+      std::stringstream name;
+      name << kMEMPOOL_NAME << "_P" << (uint16_t)i;
+      rte_mempool *mp = CreateMempool(name.str(), GetMempoolSize(1, nb_ports), socket_id);
+      if (!mp) {
         return false;
       }
+      port_mempools_[i] = mp;
     }
-
-    auto socket_id = rte_lcore_to_socket_id(lcore_id);
-    if (mempools_.find(socket_id) == mempools_.end()) {
-      rte_mempool *mp = rte_pktmbuf_pool_create(kMEMPOOL_NAME, kNB_MBUF, kCACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE, socket_id);
+  }
+  else {
+    std::unordered_map<unsigned, rte_mempool *> socket_mempools;
+    for (auto &it : socket_ports) {
+      std::stringstream name;
+      name << kMEMPOOL_NAME << "_S" << it.first;
+      rte_mempool *mp = CreateMempool(name.str(), GetMempoolSize(it.second, nb_ports), it.first);
       if (!mp) {
-        LOG(ERROR) << "Can't create mempool for socket_id=" << (uint16_t)socket_id;
         return false;
       }
-      mempools_.emplace(socket_id, mp);
-      LOG(INFO) << "Mempool for socket_id=" << (uint16_t)socket_id << " allocated";
+      socket_mempools.emplace(it.first, mp);
+    }
+    for (uint8_t i = 0; i < nb_ports; ++i) {
+      port_mempools_[i] = socket_mempools.at(rte_lcore_to_socket_id(port_lcores[i]));
+    }
+  }
+  // Clones only refer to data of rx-mbufs, so their mempools have no data room
+  for (auto &it : socket_ports) {
+    std::stringstream name;
+    name << kCLONE_MEMPOOL_NAME << "_S" << it.first;
+    rte_mempool *mp = CreateMempool(name.str(), GetTxMbufs(it.second, nb_ports) + it.second * mbuf_cache_, it.first, 0);
+    if (!mp) {
+      return false;
     }
+    clone_mempools_[it.first] = mp;
+  }
 
-    if (!InitializePort(i, socket_id)) {
+  unsigned lcore_id = RTE_MAX_LCORE;
+  for (uint8_t i = 0; i < nb_ports; ++i) {
+    lcore_id = port_lcores[i];
+    if (!InitializePort(i, rte_lcore_to_socket_id(lcore_id))) {
       return false;
     }
 
     PortBase *port = new PortEthernet(i);
+    port->SetPtypeOffload(CheckPtypeOffload(i));
+    port->SetTxRetries(tx_retries_);
+    port->SetBurstSize(burst_size_);
     ports_.push_back(port);
     ports_map_.emplace(lcore_id, port);
     LOG(INFO) << "Port mapping: port_id=" << (uint16_t)i << "->lcore_id=" << (uint16_t)lcore_id;
+  }
 
-    ++lcore_id;
+  // Each processing lcore has own tx-queue, tx-ring (and scheduler) for each output port
+  for (auto &it : ports_map_) {
+    for (uint8_t i = 0; i < nb_ports; ++i) {
+      port_tx_table_[it.first][i] = new PortQueue;
+      tx_rings_[it.first][i] = new TxRing;
+      if (egress_sched_) {
+        schedulers_[it.first][i] = new EgressScheduler;
+      }
+    }
+  }
+  if (egress_sched_) {
+    LOG(INFO) << "Egress scheduler is enabled";
   }
 
-  stats_lcore_id_ = --lcore_id; // last slave lcore
+  stats_lcore_id_ = lcore_id; // lcore of the last port
   LOG(INFO) << "Note: lcore_id=" << (uint16_t)lcore_id << " will be used for statistics (if required)";
 
   CheckPortsLinkStatus(nb_ports);
@@ -89,61 +199,257 @@ PortBase *PortManager::GetPortByIndex(const uint8_t port_id) const {
 }
 
 PortQueue *PortManager::GetPortTxQueue(const unsigned lcore_id, const uint8_t port_id) {
-  return &port_tx_table_[lcore_id][port_id];
+  return port_tx_table_[lcore_id][port_id];
+}
+
+TxRing *PortManager::GetPortTxRing(const unsigned lcore_id, const uint8_t port_id) const {
+  return tx_rings_[lcore_id][port_id];
+}
+
+EgressScheduler *PortManager::GetScheduler(const unsigned lcore_id, const uint8_t port_id) const {
+  return schedulers_[lcore_id][port_id];
 }
 
 unsigned PortManager::GetStatsLcoreId() const {
   return stats_lcore_id_;
 }
 
-rte_mbuf *PortManager::CopyMbuf(rte_mbuf *src) const {
+rte_mbuf *PortManager::CopyMbuf(rte_mbuf *src, const uint8_t port_id) const {
   assert(RTE_MBUF_DIRECT(src) == true);
 
-  const unsigned socket_id = rte_lcore_to_socket_id(rte_lcore_id());
-  rte_mempool *mp = mempools_.at(socket_id);
+  // Copy is allocated on socket of egress port, so NIC reads it from local memory
+  rte_mempool *mp = port_mempools_[port_id];
   rte_mbuf *m = rte_pktmbuf_alloc(mp);
   if (m == nullptr) {
     LOG(WARNING) << "mbuf_alloc failed";
     return nullptr;
   }
 
-  if (rte_pktmbuf_append(m, src->pkt_len) == nullptr) {
-    LOG(WARNING) << "mbuf_append failed";
-    rte_pktmbuf_free(m);
-    return nullptr;
+  // Source segments are copied into a chain of new segments
+  rte_mbuf *m_last = m;
+  for (const rte_mbuf *seg = src; seg != nullptr; seg = seg->next) {
+    const char *src_data = rte_pktmbuf_mtod(seg, const char *);
+    uint16_t remain = seg->data_len;
+    while (remain > 0) {
+      if (rte_pktmbuf_tailroom(m_last) == 0) {
+        rte_mbuf *m_next = rte_pktmbuf_alloc(mp);
+        if (m_next == nullptr) {
+          LOG(WARNING) << "mbuf_alloc failed";
+          rte_pktmbuf_free(m);
+          return nullptr;
+        }
+        m_last->next = m_next;
+        m_last = m_next;
+        ++m->nb_segs;
+      }
+
+      const uint16_t copy_len = RTE_MIN(remain, rte_pktmbuf_tailroom(m_last));
+      char *dst_data = rte_pktmbuf_mtod_offset(m_last, char *, m_last->data_len);
+      rte_memcpy(dst_data, src_data, copy_len);
+      m_last->data_len += copy_len;
+      m->pkt_len += copy_len;
+      src_data += copy_len;
+      remain -= copy_len;
+    }
   }
 
-  char *dst_data = rte_pktmbuf_mtod(m, char *);
-  const char *src_data = rte_pktmbuf_mtod(src, char *);
-  assert(dst_data != nullptr);
-  assert(src_data != nullptr);
-  rte_memcpy(dst_data, src_data, m->pkt_len);
+  return m;
+}
+
+// Clone refers to data of source (no copying), its mbufs are taken from clone mempool of lcore's socket
+rte_mbuf *PortManager::CloneMbuf(rte_mbuf *src) const {
+  rte_mbuf *m = rte_pktmbuf_clone(src, clone_mempools_[rte_socket_id()]);
+  if (m == nullptr) {
+    LOG(WARNING) << "mbuf_clone failed";
+  }
 
   return m;
 }
 
+bool PortManager::PlacePorts(const uint8_t nb_ports, std::vector<unsigned> &port_lcores) const {
+  const unsigned master_lcore = rte_get_master_lcore();
+  std::vector<bool> used_lcores(RTE_MAX_LCORE, false);
+  port_lcores.assign(nb_ports, RTE_MAX_LCORE);
+
+  // Explicit mapping goes first
+  for (auto &it : port_lcore_map_) {
+    if (it.first >= nb_ports) {
+      LOG(ERROR) << "Port " << (uint16_t)it.first << " from port-lcore-map doesn't exist";
+      return false;
+    }
+    if (!rte_lcore_is_enabled(it.second) || it.second == master_lcore || used_lcores[it.second]) {
+      LOG(ERROR) << "Lcore " << it.second << " from port-lcore-map can't be used for port " << (uint16_t)it.first;
+      return false;
+    }
+    port_lcores[it.first] = it.second;
+    used_lcores[it.second] = true;
+  }
+
+  // Other ports get free lcore on own socket if possible
+  for (uint8_t i = 0; i < nb_ports; ++i) {
+    if (port_lcores[i] != RTE_MAX_LCORE) {
+      continue;
+    }
+    const int port_socket_id = rte_eth_dev_socket_id(i);
+    unsigned lcore_id, any_lcore_id = RTE_MAX_LCORE;
+    RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+      if (used_lcores[lcore_id]) {
+        continue;
+      }
+      if (port_socket_id == SOCKET_ID_ANY || (unsigned)port_socket_id == rte_lcore_to_socket_id(lcore_id)) {
+        break;
+      }
+      if (any_lcore_id == RTE_MAX_LCORE) {
+        any_lcore_id = lcore_id;
+      }
+    }
+    if (lcore_id >= RTE_MAX_LCORE) {
+      lcore_id = any_lcore_id;
+    }
+    if (lcore_id >= RTE_MAX_LCORE) {
+      LOG(ERROR) << "Can't find core for each port";
+      return false;
+    }
+    port_lcores[i] = lcore_id;
+    used_lcores[lcore_id] = true;
+  }
+
+  for (uint8_t i = 0; i < nb_ports; ++i) {
+    const int port_socket_id = rte_eth_dev_socket_id(i);
+    if (port_socket_id != SOCKET_ID_ANY && (unsigned)port_socket_id != rte_lcore_to_socket_id(port_lcores[i])) {
+      LOG(WARNING) << "Port " << (uint16_t)i << " on socket " << port_socket_id << " is polled by lcore "
+                   << port_lcores[i] << " on remote socket " << rte_lcore_to_socket_id(port_lcores[i]);
+    }
+  }
+
+  return true;
+}
+
+rte_mempool *PortManager::CreateMempool(const std::string &name, const uint32_t nb_mbufs, const unsigned socket_id,
+                                        const uint16_t data_room) {
+  if (mbuf_cache_ > nb_mbufs / 1.5) {
+    LOG(ERROR) << "Mbuf cache size " << mbuf_cache_ << " is too big for mempool of " << nb_mbufs << " mbufs";
+    return nullptr;
+  }
+  rte_mempool *mp = rte_pktmbuf_pool_create(name.c_str(), nb_mbufs, mbuf_cache_, 0, data_room, socket_id);
+  if (!mp) {
+    LOG(ERROR) << "Can't create mempool " << name << " for socket_id=" << (uint16_t)socket_id;
+    return nullptr;
+  }
+  mempools_.push_back(mp);
+  LOG(INFO) << "Mempool " << name << " of " << nb_mbufs << " mbufs for socket_id=" << (uint16_t)socket_id << " allocated";
+
+  return mp;
+}
+
+// Jumbo frames are received into chains of default-sized mbufs
+uint32_t PortManager::GetMaxSegments() const {
+  return max_pkt_len_ > ETHER_MAX_LEN ? (max_pkt_len_ + RTE_MBUF_DEFAULT_DATAROOM - 1) / RTE_MBUF_DEFAULT_DATAROOM : 1;
+}
+
+// Mbufs held on the way to output ports by lcores of the socket and by tx-descriptors of all ports
+uint32_t PortManager::GetTxMbufs(const uint8_t nb_socket_ports, const uint8_t nb_ports) const {
+  // Packets held by single processing lcore: queued for each output port
+  uint32_t lcore_pkts = nb_ports * (burst_size_ + kTX_RING_SIZE);
+  if (egress_sched_) {
+    lcore_pkts += nb_ports * (SCHED_CLASSES * kSCHED_QUEUE_SIZE + burst_size_);
+  }
+  // Packets may be sent to any port, so tx-descriptors of all ports are counted
+  return (nb_socket_ports * lcore_pkts + nb_ports * nb_txd_) * GetMaxSegments();
+}
+
+// Clones don't hold data, but keep rx-mbufs referenced until they are sent or written:
+// mirrored packets may take each tx-slot next to copies, captured and sampled ones wait in rings
+uint32_t PortManager::GetMempoolSize(const uint8_t nb_socket_ports, const uint8_t nb_ports) const {
+  const uint32_t nb_mbufs = nb_socket_ports * (nb_rxd_ + burst_size_ * GetMaxSegments() + mbuf_cache_) +
+                            2 * GetTxMbufs(nb_socket_ports, nb_ports) + nb_socket_ports * kCLONE_PORT_MBUFS;
+  if (nb_mbufs_ == 0) {
+    return nb_mbufs;
+  }
+  if (nb_mbufs_ < nb_mbufs) {
+    LOG(WARNING) << "Mempool of " << nb_mbufs_ << " mbufs may be exhausted (" << nb_mbufs << " are recommended)";
+  }
+
+  return nb_mbufs_;
+}
+
 bool PortManager::InitializePort(const uint8_t port_id, const unsigned socket_id) const {
   rte_eth_conf port_conf{};
   // Tune rx
+  rte_eth_dev_info dev_info;
+  rte_eth_dev_info_get(port_id, &dev_info);
+  uint8_t rss_key[kRSS_KEY_MAX_LEN];
+  memcpy(rss_key, kSYMMETRIC_RSS_KEY, sizeof(rss_key));
   port_conf.rxmode.mq_mode = ETH_MQ_RX_RSS;
-  port_conf.rx_adv_conf.rss_conf.rss_key = NULL; // use defaut DPDK-key
+  port_conf.rx_adv_conf.rss_conf.rss_key = rss_key;
+  port_conf.rx_adv_conf.rss_conf.rss_key_len = dev_info.hash_key_size ? dev_info.hash_key_size : kRSS_KEY_LEN;
   port_conf.rx_adv_conf.rss_conf.rss_hf = ETH_RSS_IP | ETH_RSS_TCP | ETH_RSS_UDP;
+  if (port_conf.rx_adv_conf.rss_conf.rss_key_len > kRSS_KEY_MAX_LEN) {
+    LOG(ERROR) << "Port " << (uint16_t)port_id << " requires RSS key of "
+               << (uint16_t)dev_info.hash_key_size << " bytes";
+    return false;
+  }
+  // Tune jumbo frames (received into chains of default-sized mbufs)
+  rte_eth_txconf tx_conf = dev_info.default_txconf;
+  if (!DescriptorsAreValid(nb_rxd_, dev_info.rx_desc_lim) || !DescriptorsAreValid(nb_txd_, dev_info.tx_desc_lim)) {
+    LOG(ERROR) << "Port " << (uint16_t)port_id << " doesn't support rxd=" << nb_rxd_ << ",txd=" << nb_txd_
+               << " (rx: " << dev_info.rx_desc_lim.nb_min << "-" << dev_info.rx_desc_lim.nb_max
+               << " aligned by " << dev_info.rx_desc_lim.nb_align
+               << ", tx: " << dev_info.tx_desc_lim.nb_min << "-" << dev_info.tx_desc_lim.nb_max
+               << " aligned by " << dev_info.tx_desc_lim.nb_align << ")";
+    return false;
+  }
+  if (max_pkt_len_ > ETHER_MAX_LEN) {
+    if (max_pkt_len_ > dev_info.max_rx_pktlen) {
+      LOG(ERROR) << "Port " << (uint16_t)port_id << " doesn't support max-pkt-len=" << max_pkt_len_
+                 << " (limit is " << dev_info.max_rx_pktlen << ")";
+      return false;
+    }
+    port_conf.rxmode.jumbo_frame = 1;
+    port_conf.rxmode.max_rx_pkt_len = max_pkt_len_;
+    port_conf.rxmode.enable_scatter = 1;
+    tx_conf.txq_flags &= ~ETH_TXQ_FLAGS_NOMULTSEGS;
+  }
+  // Mirrored packets are indirect mbufs sharing data with received ones, so tx has to respect refcounts
+  tx_conf.txq_flags &= ~(ETH_TXQ_FLAGS_NOREFCOUNT | ETH_TXQ_FLAGS_NOMULTMEMP);
   // Tune tx
   port_conf.txmode.mq_mode = ETH_MQ_TX_NONE;
+
+  // Rx interrupts wake up idle lcore, port is started without them if PMD or UIO driver doesn't support them
+  if (adaptive_poll_) {
+    port_conf.intr_conf.rxq = 1;
+    if (StartPort(port_id, socket_id, port_conf, tx_conf)) {
+      rte_eth_promiscuous_enable(port_id);
+      return true;
+    }
+    LOG(WARNING) << "Port " << (uint16_t)port_id << " is started again without rx interrupts";
+    port_conf.intr_conf.rxq = 0;
+  }
+  if (!StartPort(port_id, socket_id, port_conf, tx_conf)) {
+    return false;
+  }
+
+  rte_eth_promiscuous_enable(port_id);
+
+  return true;
+}
+
+bool PortManager::StartPort(const uint8_t port_id, const unsigned socket_id, const rte_eth_conf &port_conf,
+                            const rte_eth_txconf &tx_conf) const {
   auto ret = rte_eth_dev_configure(port_id, kNB_RX, kNB_TX, &port_conf);
   if (ret < 0) {
     LOG(ERROR) << "Can't configure port " << (uint16_t)port_id << ", error=" << ret;
     return false;
   }
 
-  rte_mempool *mp = mempools_.at(socket_id);
+  rte_mempool *mp = port_mempools_[port_id];
   assert(mp != nullptr);
-  ret = rte_eth_rx_queue_setup(port_id, 0, kNB_RXD, socket_id, nullptr, mp);
+  ret = rte_eth_rx_queue_setup(port_id, 0, nb_rxd_, socket_id, nullptr, mp);
   if (ret < 0) {
     LOG(ERROR) << "Can't setup rx-queue for port " << (uint16_t)port_id << ", error=" << ret;
     return false;
   }
-  ret = rte_eth_tx_queue_setup(port_id, 0, kNB_TXD, socket_id, nullptr);
+  ret = rte_eth_tx_queue_setup(port_id, 0, nb_txd_, socket_id, &tx_conf);
   if (ret < 0) {
     LOG(ERROR) << "Can't setup tx-queue for port " << (uint16_t)port_id << ", error=" << ret;
     return false;
@@ -155,11 +461,34 @@ bool PortManager::InitializePort(const uint8_t port_id, const unsigned socket_id
     return false;
   }
 
-  rte_eth_promiscuous_enable(port_id);
-
   return true;
 }
 
+bool PortManager::CheckPtypeOffload(const uint8_t port_id) const {
+  constexpr uint32_t ptype_mask = RTE_PTYPE_L2_MASK | RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK;
+  auto nb_ptypes = rte_eth_dev_get_supported_ptypes(port_id, ptype_mask, nullptr, 0);
+  if (nb_ptypes <= 0) {
+    LOG(INFO) << "Packet type offload isn't supported by port " << (uint16_t)port_id;
+    return false;
+  }
+
+  std::vector<uint32_t> ptypes(nb_ptypes);
+  nb_ptypes = rte_eth_dev_get_supported_ptypes(port_id, ptype_mask, ptypes.data(), nb_ptypes);
+  uint32_t l2_mask = 0, l3_mask = 0;
+  for (int i = 0; i < nb_ptypes; ++i) {
+    l2_mask |= ptypes[i] & RTE_PTYPE_L2_MASK;
+    l3_mask |= ptypes[i] & RTE_PTYPE_L3_MASK;
+  }
+
+  // Packet type can be used only if NIC recognizes headers at each level
+  const bool ret = l2_mask != 0 && l3_mask != 0 &&
+                   std::find(ptypes.cbegin(), ptypes.cend(), RTE_PTYPE_L4_TCP) != ptypes.cend() &&
+                   std::find(ptypes.cbegin(), ptypes.cend(), RTE_PTYPE_L4_UDP) != ptypes.cend();
+  LOG(INFO) << "Packet type offload is " << (ret ? "used" : "not used") << " for port " << (uint16_t)port_id;
+
+  return ret;
+}
+
 void PortManager::CheckPortsLinkStatus(const uint8_t nb_ports) const {
   constexpr uint8_t CHECK_INTERVAL = 100; // 100ms
   constexpr uint8_t MAX_CHECK_TIME = 90;  // 9s (90 * 100ms)
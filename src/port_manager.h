@@ -5,12 +5,31 @@
 #include <rte_ethdev.h>
 #include <rte_mempool.h>
 #include <memory>
+#include <string>
+#include <vector>
+#include <map>
 #include <unordered_map>
 #include "port.h"
+#include "scheduler.h"
+#include "cmd_args.h"
+
+// Toeplitz key with repeated 16-bit pattern: hash doesn't change when addresses and ports are swapped,
+// so both directions of flow are received by the same queue (NICs use 40 or 52 bytes of it)
+static constexpr uint8_t kRSS_KEY_LEN = 40;
+static constexpr uint8_t kRSS_KEY_MAX_LEN = 52;
+static constexpr uint8_t kSYMMETRIC_RSS_KEY[kRSS_KEY_MAX_LEN] = {
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+  0x6d, 0x5a, 0x6d, 0x5a,
+};
 
 class PortManager {
  public:
-  PortManager();
+  explicit PortManager(const CmdArgs &);
   ~PortManager();
 
   PortManager(const PortManager &) = delete;
@@ -19,22 +38,50 @@ class PortManager {
   PortManager &operator=(PortManager &&) = delete;
 
   bool Initialize();
+  void Shutdown();
   PortBase *GetPortByCore(const unsigned) const;
   PortBase *GetPortByIndex(const uint8_t) const;
   PortQueue *GetPortTxQueue(const unsigned, const uint8_t);
+  TxRing *GetPortTxRing(const unsigned, const uint8_t) const;
+  EgressScheduler *GetScheduler(const unsigned, const uint8_t) const;
   unsigned GetStatsLcoreId() const;
-  rte_mbuf *CopyMbuf(rte_mbuf *) const;
+  rte_mbuf *CopyMbuf(rte_mbuf *, const uint8_t) const;
+  rte_mbuf *CloneMbuf(rte_mbuf *) const;
 
  protected:
+  void FreeTxQueues();
+  bool PlacePorts(const uint8_t, std::vector<unsigned> &) const;
+  rte_mempool *CreateMempool(const std::string &, const uint32_t, const unsigned,
+                             const uint16_t = RTE_MBUF_DEFAULT_BUF_SIZE);
+  uint32_t GetMaxSegments() const;
+  uint32_t GetTxMbufs(const uint8_t, const uint8_t) const;
+  uint32_t GetMempoolSize(const uint8_t, const uint8_t) const;
   bool InitializePort(const uint8_t, const unsigned) const;
+  bool StartPort(const uint8_t, const unsigned, const rte_eth_conf &, const rte_eth_txconf &) const;
+  bool CheckPtypeOffload(const uint8_t) const;
   void CheckPortsLinkStatus(const uint8_t) const;
 
  private:
-  std::unordered_map<unsigned, rte_mempool *> mempools_; // socket->mempool
+  std::vector<rte_mempool *> mempools_;                  // mempools
+  rte_mempool *port_mempools_[RTE_MAX_ETHPORTS];         // port->mempool for rx and copies
+  rte_mempool *clone_mempools_[RTE_MAX_NUMA_NODES];      // socket->mempool for clones
   std::unordered_map<unsigned, PortBase *> ports_map_;   // lcore->port
   std::vector<PortBase *> ports_;                        // ports
-  PortQueue port_tx_table_[RTE_MAX_LCORE][RTE_MAX_ETHPORTS];
+  PortQueue *port_tx_table_[RTE_MAX_LCORE][RTE_MAX_ETHPORTS];
+  TxRing *tx_rings_[RTE_MAX_LCORE][RTE_MAX_ETHPORTS];
+  EgressScheduler *schedulers_[RTE_MAX_LCORE][RTE_MAX_ETHPORTS]; // nullptr - scheduler isn't used
   unsigned stats_lcore_id_;
+  uint16_t max_pkt_len_;
+  bool egress_sched_;
+  uint16_t tx_retries_;
+  uint16_t burst_size_;
+  uint16_t nb_rxd_;
+  uint16_t nb_txd_;
+  uint32_t nb_mbufs_;
+  uint16_t mbuf_cache_;
+  bool mempool_per_port_;
+  bool adaptive_poll_;
+  std::map<uint8_t, unsigned> port_lcore_map_; // port->lcore
 };
 
 #endif // PORT_MANAGER_
@@ -4,60 +4,51 @@
 static constexpr auto http_min_len = 15;
 static constexpr auto http_version = "HTTP/1.1";
 static constexpr auto http_version_len = strlen(http_version);
+static constexpr size_t http_max_uri_len = 1024; // limits request-target scanning
 
-static inline bool SearchHttpMethod(char *data, const char *method) {
+static inline bool SearchHttpMethod(const char *data, const uint16_t data_len, const char *method) {
   const size_t method_len = strlen(method);
-  // Method type
-  for (size_t i = 0; i < method_len; ++i) {
-    if (*data++ != method[i]) {
-      return false;
-    }
-  }
-  // Space
-  if (*data++ != ' ') {
+  // Method type + space
+  if (data_len <= method_len || memcmp(data, method, method_len) != 0 || data[method_len] != ' ') {
     return false;
   }
+  const char *end = data + data_len;
+  data += method_len + 1;
   // Address + space
-  while (*data++ != ' ');
+  const size_t uri_len = RTE_MIN((size_t)(end - data), http_max_uri_len);
+  const char *space = (const char *)memchr(data, ' ', uri_len);
+  if (!space) {
+    return false;
+  }
+  data = space + 1;
   // Protocol version
-  for (size_t i = 0; i < http_version_len; ++i) {
-    if (*data++ != http_version[i]) {
-      return false;
-    }
+  if ((size_t)(end - data) < http_version_len) {
+    return false;
   }
 
-  return true;
+  return memcmp(data, http_version, http_version_len) == 0;
 }
 
 protocol_type SearchHttp(rte_mbuf *m) {
-  const uint16_t headers_len = m->l2_len + m->l3_len + m->l4_len;
-  const uint16_t payload_len = m->pkt_len - headers_len;
+  char buf[kMAX_PAYLOAD_INSPECT_LEN];
+  uint16_t payload_len;
+  const char *payload = GetPayload(m, buf, payload_len);
   if (payload_len < http_min_len) return UNKNOWN;
 
-  char *payload = rte_pktmbuf_mtod_offset(m, char *, headers_len);
-
   // Response case
-  bool response = true;
-  char *tmp_payload = payload;
-  for (size_t i = 0; i < http_version_len; ++i) {
-    if (*tmp_payload++ != http_version[i]) {
-      response = false;
-      break;
-    }
-  }
-  if (response) {
+  if (memcmp(payload, http_version, http_version_len) == 0) {
     return HTTP;
   }
 
   // Methods
-  if (SearchHttpMethod(payload, "OPTIONS")) return HTTP;
-  if (SearchHttpMethod(payload, "GET")) return HTTP;
-  if (SearchHttpMethod(payload, "HEAD")) return HTTP;
-  if (SearchHttpMethod(payload, "POST")) return HTTP;
-  if (SearchHttpMethod(payload, "PUT")) return HTTP;
-  if (SearchHttpMethod(payload, "DELETE")) return HTTP;
-  if (SearchHttpMethod(payload, "TRACE")) return HTTP;
-  if (SearchHttpMethod(payload, "CONNECT")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "OPTIONS")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "GET")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "HEAD")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "POST")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "PUT")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "DELETE")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "TRACE")) return HTTP;
+  if (SearchHttpMethod(payload, payload_len, "CONNECT")) return HTTP;
 
   return UNKNOWN;
 }
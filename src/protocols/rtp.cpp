@@ -2,17 +2,17 @@
 #include <rte_byteorder.h>
 
 protocol_type SearchRtp(rte_mbuf *m) {
-  const uint16_t headers_len = m->l2_len + m->l3_len + m->l4_len;
-  const uint16_t payload_len = m->pkt_len - headers_len;
+  char buf[kMAX_PAYLOAD_INSPECT_LEN];
+  uint16_t payload_len;
+  const uint8_t *payload = (const uint8_t *)GetPayload(m, buf, payload_len);
   // minimum 12 bytes
   uint16_t rtp_min_len = 12;
   if (payload_len < rtp_min_len) return UNKNOWN;
 
-  uint8_t *payload = rte_pktmbuf_mtod_offset(m, uint8_t *, headers_len);
   // current version is 2
   if (!(payload[0] & 0x80)) return UNKNOWN;
 
-  uint32_t ssrc = ((uint32_t *)(payload))[2];
+  uint32_t ssrc = ((const uint32_t *)(payload))[2];
   // ssrc can't be 0
   if (ssrc == 0) return UNKNOWN;
 
@@ -30,7 +30,7 @@ protocol_type SearchRtp(rte_mbuf *m) {
 
     // profile-specific id
     rtp_min_len += 2;
-    uint16_t extension_len = 4*rte_cpu_to_be_16(*(uint16_t *)(payload + rtp_min_len));
+    uint16_t extension_len = 4*rte_cpu_to_be_16(*(const uint16_t *)(payload + rtp_min_len));
     // extension header len
     rtp_min_len += 2;
 
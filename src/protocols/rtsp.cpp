@@ -1,70 +1,50 @@
 #include <string.h>
+#include <strings.h>
 #include "common.h"
 
 static constexpr auto rtsp_min_len = 15;
 static constexpr auto rtsp_version = "RTSP/1.0";
 static constexpr auto rtsp_version_len = strlen(rtsp_version);
-static constexpr auto rtsp_prefix_up = "RTSP://";
-static constexpr auto rtsp_prefix_lo = "rtsp://";
-static constexpr auto rtsp_prefix_len = strlen(rtsp_prefix_up);
+static constexpr auto rtsp_prefix = "rtsp://";
+static constexpr auto rtsp_prefix_len = strlen(rtsp_prefix);
 
-static inline bool SearchRtspMethod(char *data, const char *method) {
+static inline bool SearchRtspMethod(const char *data, const uint16_t data_len, const char *method) {
   const size_t method_len = strlen(method);
-  // Method type
-  for (size_t i = 0; i < method_len; ++i) {
-    if (*data++ != method[i]) {
-      return false;
-    }
-  }
-  // Space
-  if (*data++ != ' ') {
+  // Method type + space
+  if (data_len <= method_len || memcmp(data, method, method_len) != 0 || data[method_len] != ' ') {
     return false;
   }
-  // Protocol prefix
-  for (size_t i = 0; i < rtsp_prefix_len; ++i) {
-    if (*data != rtsp_prefix_up[i]) {
-      if (*data != rtsp_prefix_lo[i]) {
-        return false;
-      }
-    }
-    ++data;
+  // Protocol prefix (any case)
+  if (data_len - method_len - 1 < rtsp_prefix_len) {
+    return false;
   }
 
-  return true;
+  return strncasecmp(data + method_len + 1, rtsp_prefix, rtsp_prefix_len) == 0;
 }
 
 protocol_type SearchRtsp(rte_mbuf *m) {
-  const uint16_t headers_len = m->l2_len + m->l3_len + m->l4_len;
-  const uint16_t payload_len = m->pkt_len - headers_len;
+  char buf[kMAX_PAYLOAD_INSPECT_LEN];
+  uint16_t payload_len;
+  const char *payload = GetPayload(m, buf, payload_len);
   if (payload_len < rtsp_min_len) return UNKNOWN;
 
-  char *payload = rte_pktmbuf_mtod_offset(m, char *, headers_len);
-
   // Response case
-  bool response = true;
-  char *tmp_payload = payload;
-  for (size_t i = 0; i < rtsp_version_len; ++i) {
-    if (*tmp_payload++ != rtsp_version[i]) {
-      response = false;
-      break;
-    }
-  }
-  if (response) {
+  if (memcmp(payload, rtsp_version, rtsp_version_len) == 0) {
     return RTSP;
   }
 
   // Methods
-  if (SearchRtspMethod(payload, "DESCRIBE")) return RTSP;
-  if (SearchRtspMethod(payload, "OPTIONS")) return RTSP;
-  if (SearchRtspMethod(payload, "PLAY")) return RTSP;
-  if (SearchRtspMethod(payload, "PAUSE")) return RTSP;
-  if (SearchRtspMethod(payload, "RECORD")) return RTSP;
-  if (SearchRtspMethod(payload, "REDIRECT")) return RTSP;
-  if (SearchRtspMethod(payload, "SETUP")) return RTSP;
-  if (SearchRtspMethod(payload, "ANNOUNCE")) return RTSP;
-  if (SearchRtspMethod(payload, "GET_PARAMETER")) return RTSP;
-  if (SearchRtspMethod(payload, "SET_PARAMETER")) return RTSP;
-  if (SearchRtspMethod(payload, "TEARDOWN")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "DESCRIBE")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "OPTIONS")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "PLAY")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "PAUSE")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "RECORD")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "REDIRECT")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "SETUP")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "ANNOUNCE")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "GET_PARAMETER")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "SET_PARAMETER")) return RTSP;
+  if (SearchRtspMethod(payload, payload_len, "TEARDOWN")) return RTSP;
 
   return UNKNOWN;
 }
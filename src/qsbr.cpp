@@ -0,0 +1,31 @@
+#include "qsbr.h"
+#include <rte_common.h>
+
+Qsbr::Qsbr() : counter_(1) {
+  for (auto &reader : readers_) {
+    reader.counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Qsbr::Online(const unsigned lcore_id) {
+  // Data is read after the reader becomes visible to writer
+  readers_[lcore_id].counter.store(counter_.load());
+}
+
+void Qsbr::Offline(const unsigned lcore_id) {
+  readers_[lcore_id].counter.store(0, std::memory_order_release);
+}
+
+void Qsbr::Quiescent(const unsigned lcore_id) {
+  readers_[lcore_id].counter.store(counter_.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+void Qsbr::Synchronize() {
+  const uint64_t counter = counter_.fetch_add(1) + 1;
+  for (auto &reader : readers_) {
+    uint64_t reader_counter;
+    while ((reader_counter = reader.counter.load(std::memory_order_acquire)) != 0 && reader_counter < counter) {
+      rte_pause();
+    }
+  }
+}
@@ -0,0 +1,35 @@
+#ifndef QSBR_
+#define QSBR_
+
+#include <atomic>
+#include <rte_config.h>
+#include "common.h"
+
+// Quiescent state based reclamation. Readers (processing lcores) report quiescent
+// state between bursts, writer waits until every online reader has passed it,
+// after that data unpublished before the wait isn't referenced by anyone.
+class Qsbr {
+ public:
+  Qsbr();
+  ~Qsbr() = default;
+
+  Qsbr(const Qsbr &) = delete;
+  Qsbr &operator=(const Qsbr &) = delete;
+  Qsbr(Qsbr &&) = delete;
+  Qsbr &operator=(Qsbr &&) = delete;
+
+  void Online(const unsigned);
+  void Offline(const unsigned);
+  void Quiescent(const unsigned);
+  void Synchronize();
+
+ private:
+  struct Reader {
+    std::atomic<uint64_t> counter; // 0 - reader is offline
+  } __attribute__((aligned(CACHE_LINE_SIZE)));
+
+  std::atomic<uint64_t> counter_;
+  Reader readers_[RTE_MAX_LCORE];
+};
+
+#endif // QSBR_
@@ -0,0 +1,96 @@
+#include "scheduler.h"
+
+// Weights of classes served by round robin (packets per round)
+static constexpr uint8_t kSCHED_WEIGHTS[SCHED_CLASSES] = {0, 3, 1};
+
+static inline sched_class GetClass(const protocol_type protocol) {
+  switch (protocol) {
+    case SIP:
+    case RTP: {
+      return SCHED_VOICE;
+    }
+    case RTSP: {
+      return SCHED_STREAMING;
+    }
+    default: {
+      return SCHED_BULK;
+    }
+  }
+}
+
+EgressScheduler::EgressScheduler() : count_(0) {
+  for (uint8_t i = 0; i < SCHED_CLASSES; ++i) {
+    queues_[i].head = queues_[i].tail = 0;
+    credits_[i] = kSCHED_WEIGHTS[i];
+  }
+}
+
+EgressScheduler::~EgressScheduler() {
+  for (uint8_t i = 0; i < SCHED_CLASSES; ++i) {
+    while (!Empty(i)) {
+      rte_pktmbuf_free(Pop(i));
+    }
+  }
+  for (uint16_t i = 0; i < pending_.count_; ++i) {
+    rte_pktmbuf_free(pending_.queue_[i]);
+  }
+}
+
+bool EgressScheduler::Enqueue(rte_mbuf *m, const protocol_type protocol) {
+  ClassQueue &queue = queues_[GetClass(protocol)];
+  if (queue.tail - queue.head == kSCHED_QUEUE_SIZE) {
+    return false;
+  }
+  queue.pkts[queue.tail++ & (kSCHED_QUEUE_SIZE - 1)] = m;
+  ++count_;
+
+  return true;
+}
+
+uint16_t EgressScheduler::Dequeue(rte_mbuf **pkts, const uint16_t max_pkts) {
+  uint16_t nb_pkts = 0;
+  while (nb_pkts < max_pkts && !Empty(SCHED_VOICE)) {
+    pkts[nb_pkts++] = Pop(SCHED_VOICE);
+  }
+
+  while (nb_pkts < max_pkts) {
+    uint8_t cls = SCHED_VOICE + 1;
+    while (cls < SCHED_CLASSES && (Empty(cls) || credits_[cls] == 0)) {
+      ++cls;
+    }
+    if (cls == SCHED_CLASSES) {
+      // Start new round if there are packets
+      bool empty = true;
+      for (uint8_t i = SCHED_VOICE + 1; i < SCHED_CLASSES; ++i) {
+        credits_[i] = kSCHED_WEIGHTS[i];
+        empty = empty && Empty(i);
+      }
+      if (empty) {
+        break;
+      }
+      continue;
+    }
+    pkts[nb_pkts++] = Pop(cls);
+    --credits_[cls];
+  }
+
+  return nb_pkts;
+}
+
+uint32_t EgressScheduler::Count() const {
+  return count_;
+}
+
+PortQueue *EgressScheduler::GetPending() {
+  return &pending_;
+}
+
+bool EgressScheduler::Empty(const uint8_t cls) const {
+  return queues_[cls].head == queues_[cls].tail;
+}
+
+rte_mbuf *EgressScheduler::Pop(const uint8_t cls) {
+  ClassQueue &queue = queues_[cls];
+  --count_;
+  return queue.pkts[queue.head++ & (kSCHED_QUEUE_SIZE - 1)];
+}
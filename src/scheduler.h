@@ -0,0 +1,51 @@
+#ifndef SCHEDULER_
+#define SCHEDULER_
+
+#include "port.h"
+
+static constexpr uint16_t kSCHED_QUEUE_SIZE = 512; // must be power of 2
+
+// Traffic classes of egress scheduler
+enum sched_class: uint8_t {
+  SCHED_VOICE,     // SIP, RTP - strict priority
+  SCHED_STREAMING, // RTSP
+  SCHED_BULK,      // HTTP and unknown
+  SCHED_CLASSES,
+};
+
+// Egress scheduler of single (lcore, port) pair. Voice class is always served first,
+// the rest classes share the remaining bandwidth by weighted round robin.
+// Packets are kept in the scheduler while NIC tx-ring is full, so class queues
+// limit latency and packets of low priority classes are dropped first.
+class EgressScheduler {
+ public:
+  EgressScheduler();
+  ~EgressScheduler();
+
+  EgressScheduler(const EgressScheduler &) = delete;
+  EgressScheduler &operator=(const EgressScheduler &) = delete;
+  EgressScheduler(EgressScheduler &&) = delete;
+  EgressScheduler &operator=(EgressScheduler &&) = delete;
+
+  bool Enqueue(rte_mbuf *, const protocol_type);
+  uint16_t Dequeue(rte_mbuf **, const uint16_t);
+  uint32_t Count() const;
+  PortQueue *GetPending();
+
+ private:
+  struct ClassQueue {
+    rte_mbuf *pkts[kSCHED_QUEUE_SIZE];
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  bool Empty(const uint8_t) const;
+  rte_mbuf *Pop(const uint8_t);
+
+  ClassQueue queues_[SCHED_CLASSES];
+  uint8_t credits_[SCHED_CLASSES];
+  uint32_t count_;
+  PortQueue pending_; // dequeued packets which weren't accepted by NIC
+};
+
+#endif // SCHEDULER_
@@ -0,0 +1,162 @@
+#include "slow_path.h"
+#include <glog/logging.h>
+#include <sstream>
+#include <rte_jhash.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+static constexpr auto kSLOW_PATH_RING_NAME = "SLOW_PATH";
+static constexpr auto kSIP_VERSION = "SIP/2.0 ";
+static constexpr auto kSIP_MAX_METHOD_LEN = 16;
+static constexpr uint32_t kSAMPLE_SEED = 0x7f4a7c15;
+
+// Methods are followed by response classes and the rest messages
+static const char *kSIP_MESSAGE_NAMES[kSIP_MESSAGE_TYPES] = {
+  "INVITE", "ACK", "BYE", "CANCEL", "REGISTER", "OPTIONS", "PRACK",
+  "SUBSCRIBE", "NOTIFY", "PUBLISH", "INFO", "REFER", "MESSAGE", "UPDATE",
+  "1xx", "2xx", "3xx", "4xx", "5xx", "6xx",
+  "other",
+};
+
+RTE_DEFINE_PER_LCORE(uint32_t, sample_seed) = 0x12345678;
+
+// xorshift32, state is per lcore
+static inline uint32_t SampleRandom() {
+  uint32_t &x = RTE_PER_LCORE(sample_seed);
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+// All packets of flow are sampled or none. RSS hash of NIC isn't used: it omits ports of non-first fragments
+// and covers outer headers of tunnels, so decision for the same flow would depend on NIC.
+bool SamplePacket(const uint32_t *flow_hash, const uint32_t rate, const bool by_flow) {
+  if (!by_flow) {
+    return SampleRandom() % rate == 0;
+  }
+  if (!flow_hash) {
+    return false;
+  }
+  // Low bits of flow hash select bucket of flow table, so sampled flows don't depend on them
+  return MixHash(*flow_hash ^ kSAMPLE_SEED) % rate == 0;
+}
+
+SlowPath::SlowPath() : enabled_(false) {
+  memset(packets_, 0, sizeof(packets_));
+  memset(bytes_, 0, sizeof(bytes_));
+  memset(sip_messages_, 0, sizeof(sip_messages_));
+}
+
+SlowPath::~SlowPath() {
+  Close();
+}
+
+SlowPath &SlowPath::Instance() {
+  static SlowPath instance;
+
+  return instance;
+}
+
+// Called by rules parsing, so it's initialized only if SAMPLE is used
+bool SlowPath::Initialize() {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (ring_.IsCreated()) {
+    return true;
+  }
+
+  if (!ring_.Create(kSLOW_PATH_RING_NAME, kSLOW_PATH_RING_SIZE)) {
+    LOG(ERROR) << "Can't create ring for slow path";
+    return false;
+  }
+  enabled_ = true;
+
+  return true;
+}
+
+// Header lengths (needed to find payload) are copied by clone
+bool SlowPath::Enqueue(rte_mbuf *m, const protocol_type protocol) {
+  return ring_.Enqueue(m, protocol);
+}
+
+void SlowPath::Process() {
+  if (!ring_.IsCreated()) {
+    return;
+  }
+  rte_mbuf *pkts[kCLONE_RING_BURST];
+  unsigned n;
+  while ((n = ring_.Dequeue(pkts, kCLONE_RING_BURST)) > 0) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (unsigned i = 0; i < n; ++i) {
+      Analyze(pkts[i], (protocol_type)pkts[i]->udata64);
+      CloneRing::Release(pkts[i]);
+    }
+  }
+}
+
+void SlowPath::Close() {
+  Process();
+  std::lock_guard<std::mutex> lock(lock_);
+  ring_.Free();
+}
+
+std::string SlowPath::GetStats() {
+  std::ostringstream os;
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!enabled_) {
+    return std::string();
+  }
+  os << "Sampled packets (packets/bytes/distinct payloads):\n";
+  for (uint8_t i = 0; i <= UNKNOWN; ++i) {
+    os << "  " << GetProtocolName((protocol_type)i) << ": " << packets_[i] << "/" << bytes_[i] << "/" << payloads_[i].Estimate() << "\n";
+  }
+  if (packets_[SIP]) {
+    os << "Sampled SIP messages:\n";
+    for (uint8_t i = 0; i < kSIP_MESSAGE_TYPES; ++i) {
+      if (sip_messages_[i]) {
+        os << "  " << kSIP_MESSAGE_NAMES[i] << ": " << sip_messages_[i] << "\n";
+      }
+    }
+  }
+
+  return os.str();
+}
+
+void SlowPath::Analyze(const rte_mbuf *m, const protocol_type protocol) {
+  packets_[protocol]++;
+  bytes_[protocol] += m->pkt_len;
+
+  char buf[kMAX_PAYLOAD_INSPECT_LEN];
+  uint16_t payload_len;
+  const char *payload = GetPayload(m, buf, payload_len);
+  if (!payload || payload_len == 0) {
+    return;
+  }
+  payloads_[protocol].Add(rte_jhash(payload, payload_len, 0));
+
+  // Requests are counted by method, responses by status class. Set of names is fixed,
+  // so crafted messages can't grow statistics.
+  if (protocol == SIP) {
+    uint8_t type = kSIP_MESSAGE_TYPES - 1;
+    const size_t version_len = strlen(kSIP_VERSION);
+    if (payload_len > version_len && memcmp(payload, kSIP_VERSION, version_len) == 0) {
+      const char status_class = payload[version_len];
+      if (status_class >= '1' && status_class < '1' + kSIP_RESPONSE_CLASSES) {
+        type = kSIP_METHODS + status_class - '1';
+      }
+    }
+    else {
+      const char *space = (const char *)memchr(payload, ' ', RTE_MIN(payload_len, kSIP_MAX_METHOD_LEN));
+      if (space) {
+        const size_t method_len = space - payload;
+        for (uint8_t i = 0; i < kSIP_METHODS; ++i) {
+          if (strlen(kSIP_MESSAGE_NAMES[i]) == method_len && memcmp(payload, kSIP_MESSAGE_NAMES[i], method_len) == 0) {
+            type = i;
+            break;
+          }
+        }
+      }
+    }
+    sip_messages_[type]++;
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef SLOW_PATH_
+#define SLOW_PATH_
+
+#include <mutex>
+#include <string>
+#include "clone_ring.h"
+#include "hyperloglog.h"
+
+static constexpr uint32_t kSLOW_PATH_RING_SIZE = 4096; // must be power of 2
+static constexpr uint8_t kSIP_METHODS = 14;
+static constexpr uint8_t kSIP_RESPONSE_CLASSES = 6;
+// Known methods, response classes and the rest messages
+static constexpr uint8_t kSIP_MESSAGE_TYPES = kSIP_METHODS + kSIP_RESPONSE_CLASSES + 1;
+
+// Sampling decision of SAMPLE action: random packets or whole flows (by flow key hash,
+// nullptr for packets without flow key, they aren't sampled by flow)
+bool SamplePacket(const uint32_t *, const uint32_t, const bool);
+
+// Deep inspection of sampled packets. Processing lcores enqueue clones of packets (data isn't copied),
+// analysis is done at master lcore, so its cost depends on sample rate only.
+class SlowPath {
+ public:
+  SlowPath();
+  ~SlowPath();
+
+  SlowPath(const SlowPath &) = delete;
+  SlowPath &operator=(const SlowPath &) = delete;
+  SlowPath(SlowPath &&) = delete;
+  SlowPath &operator=(SlowPath &&) = delete;
+
+  static SlowPath &Instance();
+  bool Initialize();
+  bool Enqueue(rte_mbuf *, const protocol_type);
+  void Process();
+  void Close();
+  std::string GetStats();
+
+ private:
+  void Analyze(const rte_mbuf *, const protocol_type);
+
+  std::mutex lock_;        // protects initialization and statistics
+  CloneRing ring_;
+  bool enabled_;           // SAMPLE action was configured
+  uint64_t packets_[UNKNOWN + 1];
+  uint64_t bytes_[UNKNOWN + 1];
+  HyperLogLog payloads_[UNKNOWN + 1];   // distinct payloads
+  uint64_t sip_messages_[kSIP_MESSAGE_TYPES];
+};
+
+#endif // SLOW_PATH_
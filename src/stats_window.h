@@ -0,0 +1,41 @@
+#ifndef STATS_WINDOW_
+#define STATS_WINDOW_
+
+#include <mutex>
+
+// Result of the last finished window of statistics which are updated by single lcore.
+// Lcore doesn't wait if the result is being read, the window is just continued.
+template <typename T>
+class StatsWindow {
+ public:
+  StatsWindow() : published_() {}
+  ~StatsWindow() = default;
+
+  StatsWindow(const StatsWindow &) = delete;
+  StatsWindow &operator=(const StatsWindow &) = delete;
+  StatsWindow(StatsWindow &&) = delete;
+  StatsWindow &operator=(StatsWindow &&) = delete;
+
+  // finish(T &) stores the current window and starts a new one
+  template <typename F>
+  bool TryPublish(F finish) {
+    std::unique_lock<std::mutex> lock(lock_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return false;
+    }
+    finish(published_);
+    return true;
+  }
+
+  template <typename F>
+  void Read(F read) {
+    std::lock_guard<std::mutex> lock(lock_);
+    read(static_cast<const T &>(published_));
+  }
+
+ private:
+  std::mutex lock_;
+  T published_;
+};
+
+#endif // STATS_WINDOW_
@@ -2,6 +2,7 @@
 #include "utils.h"
 #include "common.h"
 #include <rte_byteorder.h>
+#include <rte_ip.h>
 #include <glog/logging.h>
 
 using namespace packet_modifier;
@@ -113,6 +114,8 @@ TEST(PushVlanAction, PushIntoPacketWithVlan) {
   // Check packet ethertype
   uint16_t pkt_eth_type = *rte_pktmbuf_mtod_offset(m, uint16_t *, 12+4+4);
   ASSERT_EQ(rte_cpu_to_be_16(pkt_eth_type), 0x0800);
+  // Header length is updated for the next actions
+  ASSERT_EQ(m->l2_len, 18+4);
 }
 
 TEST(PushMplsAction, PushIntoPacketWithoutVlan) {
@@ -222,4 +225,241 @@ TEST(PushMplsAction, PushIntoPacketWithVlan) {
   // Check packet ethertype
   uint16_t pkt_eth_type = *rte_pktmbuf_mtod_offset(m, uint16_t *, 12+4);
   ASSERT_EQ(rte_cpu_to_be_16(pkt_eth_type), 0x8847);
+  ASSERT_EQ(m->l2_len, 18+4);
+}
+
+TEST(TruncateAction, TruncateClone) {
+  uint8_t data[100];
+  for (uint8_t i = 0; i < sizeof(data); ++i) {
+    data[i] = i;
+  }
+  auto m = InitSegmentedPacket(data, sizeof(data), 30);
+  auto m_clone = rte_pktmbuf_clone(m, m->pool);
+  ASSERT_NE(m_clone, nullptr);
+  // Length isn't changed if packet is shorter
+  ExecuteTruncate(m_clone, 200);
+  ASSERT_EQ(m_clone->pkt_len, sizeof(data));
+  ASSERT_EQ(m_clone->nb_segs, 4);
+  // The rest of segments are freed, original packet isn't changed
+  ExecuteTruncate(m_clone, 64);
+  ASSERT_EQ(m_clone->pkt_len, 64U);
+  ASSERT_EQ(m_clone->nb_segs, 3);
+  ASSERT_EQ(m_clone->next->next->data_len, 4);
+  ASSERT_EQ(m_clone->next->next->next, nullptr);
+  ASSERT_EQ(*rte_pktmbuf_mtod_offset(m_clone->next->next, uint8_t *, 3), 63);
+  ASSERT_EQ(m->pkt_len, sizeof(data));
+  ASSERT_EQ(m->nb_segs, 4);
+  // Segment boundary
+  ExecuteTruncate(m_clone, 60);
+  ASSERT_EQ(m_clone->pkt_len, 60U);
+  ASSERT_EQ(m_clone->nb_segs, 2);
+  ASSERT_EQ(m_clone->next->data_len, 30);
+  ASSERT_EQ(m_clone->next->next, nullptr);
+  rte_pktmbuf_free(m_clone);
+  rte_pktmbuf_free(m);
+}
+
+static rte_mbuf *InitIpv4Packet(const uint8_t ttl) {
+  auto m = InitUdpPacket(1, 2, 5060, 5060, std::string(4, '\0'));
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ipv4->type_of_service = 0x01; // ecn=1
+  ipv4->time_to_live = ttl;
+  ipv4->hdr_checksum = 0;
+  ipv4->hdr_checksum = rte_ipv4_cksum(ipv4);
+
+  return m;
+}
+
+static bool Ipv4ChecksumIsValid(ipv4_hdr *ipv4) {
+  const uint16_t cksum = ipv4->hdr_checksum;
+  ipv4->hdr_checksum = 0;
+  const uint16_t expected = rte_ipv4_cksum(ipv4);
+  ipv4->hdr_checksum = cksum;
+
+  return cksum == expected;
+}
+
+TEST(SetDscpAction, Ipv4) {
+  auto m = InitIpv4Packet(64);
+  ASSERT_EQ(PreparePacket(m), true);
+  ExecuteSetDscp(m, 46);
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ASSERT_EQ(ipv4->type_of_service, (46 << 2) | 0x01);
+  ASSERT_EQ(Ipv4ChecksumIsValid(ipv4), true);
+  rte_pktmbuf_free(m);
+}
+
+TEST(SetDscpAction, Ipv6) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0xdd,
+
+    0x60, 0x3f, 0xff, 0xff, // (version, tc with ecn=3, flow label)
+    0x00, 0x08,
+    0x11, 0x40, // (next header, hop limit)
+    0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+
+    0x13, 0xc4,
+    0x13, 0xc4,
+    0x00, 0x08,
+    0x00, 0x00,
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ExecuteSetDscp(m, 46);
+  auto ipv6 = rte_pktmbuf_mtod_offset(m, ipv6_hdr *, sizeof(ether_hdr));
+  ASSERT_EQ(rte_be_to_cpu_32(ipv6->vtc_flow), 0x6bbfffffU);
+  ASSERT_EQ(ExecuteDecTtl(m), true);
+  ASSERT_EQ(ipv6->hop_limits, 0x3f);
+  rte_pktmbuf_free(m);
+}
+
+TEST(DecTtlAction, Ipv4) {
+  auto m = InitIpv4Packet(64);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(ExecuteDecTtl(m), true);
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ASSERT_EQ(ipv4->time_to_live, 63);
+  ASSERT_EQ(Ipv4ChecksumIsValid(ipv4), true);
+  rte_pktmbuf_free(m);
+
+  // Expired packet isn't changed
+  m = InitIpv4Packet(1);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(ExecuteDecTtl(m), false);
+  ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ASSERT_EQ(ipv4->time_to_live, 1);
+  rte_pktmbuf_free(m);
+}
+
+TEST(SetEthAction, DstAndSrc) {
+  auto m = InitIpv4Packet(64);
+  ASSERT_EQ(PreparePacket(m), true);
+  const ether_addr dst = {{0x00, 0x1b, 0x21, 0x01, 0x02, 0x03}};
+  const ether_addr src = {{0x00, 0x1b, 0x21, 0x04, 0x05, 0x06}};
+  ExecuteSetEthDst(m, dst);
+  ExecuteSetEthSrc(m, src);
+  auto eth = rte_pktmbuf_mtod(m, ether_hdr *);
+  ASSERT_EQ(memcmp(&eth->d_addr, &dst, sizeof(dst)), 0);
+  ASSERT_EQ(memcmp(&eth->s_addr, &src, sizeof(src)), 0);
+  ASSERT_EQ(eth->ether_type, rte_cpu_to_be_16(ETHER_TYPE_IPv4));
+  rte_pktmbuf_free(m);
+}
+
+TEST(PopVlanAction, PopFromQinQ) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+    0x88, 0xa8,
+    0x00, 0x0a, // vid=10
+    0x81, 0x00,
+    0x00, 0x14, // vid=20
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l2_len, 22);
+  ExecutePopVlan(m);
+  ASSERT_EQ(m->pkt_len, sizeof(data) - 4);
+  ASSERT_EQ(m->l2_len, 18);
+  ASSERT_EQ(memcmp(rte_pktmbuf_mtod(m, uint8_t *), data, 12), 0);
+  ASSERT_EQ(memcmp(rte_pktmbuf_mtod_offset(m, uint8_t *, 12), data + 16, sizeof(data) - 16), 0);
+  ExecutePopVlan(m);
+  ASSERT_EQ(m->l2_len, 14);
+  ASSERT_EQ(rte_cpu_to_be_16(*rte_pktmbuf_mtod_offset(m, uint16_t *, 12)), 0x0800);
+  // Packet without tags isn't changed
+  ExecutePopVlan(m);
+  ASSERT_EQ(m->pkt_len, sizeof(data) - 8);
+  ASSERT_EQ(m->l2_len, 14);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PopMplsAction, PopLabelStack) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+    0x81, 0x00,
+    0x00, 0x14, // vid=20
+    0x88, 0x47,
+    0x00, 0x01, 0x00, 0x40, // label=16
+    0x00, 0x01, 0x11, 0x40, // label=17, bos
+
+    0x60, 0x00, 0x00, 0x00,
+    0x00, 0x08,
+    0x11, 0x40, // (next header, hop limit)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x08,
+    0x00, 0x00,
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l2_len, 26);
+  ASSERT_EQ(m->l3_len, 40);
+  ExecutePopMpls(m);
+  ASSERT_EQ(m->l2_len, 22);
+  ASSERT_EQ(rte_cpu_to_be_16(*rte_pktmbuf_mtod_offset(m, uint16_t *, 16)), 0x8847);
+  ASSERT_EQ(rte_cpu_to_be_32(*rte_pktmbuf_mtod_offset(m, uint32_t *, 18)), 0x00011140U);
+  // Payload type is restored with the last label
+  ExecutePopMpls(m);
+  ASSERT_EQ(m->l2_len, 18);
+  ASSERT_EQ(m->pkt_len, sizeof(data) - 8);
+  ASSERT_EQ(memcmp(rte_pktmbuf_mtod(m, uint8_t *), data, 16), 0);
+  ASSERT_EQ(rte_cpu_to_be_16(*rte_pktmbuf_mtod_offset(m, uint16_t *, 16)), 0x86dd);
+  ASSERT_EQ(memcmp(rte_pktmbuf_mtod_offset(m, uint8_t *, 18), data + 26, sizeof(data) - 26), 0);
+  // Labels are pushed on top of the stack after VLAN tags
+  ExecutePushMpls(m, rte_cpu_to_be_32(0x00011140));
+  ASSERT_EQ(m->l2_len, 22);
+  ASSERT_EQ(rte_cpu_to_be_16(*rte_pktmbuf_mtod_offset(m, uint16_t *, 16)), 0x8847);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l2_len, 22);
+  rte_pktmbuf_free(m);
+}
+
+TEST(SetDscpAction, AfterPushVlan) {
+  auto m = InitIpv4Packet(64);
+  ASSERT_EQ(PreparePacket(m), true);
+  ExecutePushVlan(m, rte_cpu_to_be_32(0x81000064));
+  ASSERT_EQ(m->l2_len, 18);
+  ExecuteSetDscp(m, 46);
+  ASSERT_EQ(ExecuteDecTtl(m), true);
+  // Vlan tag isn't touched, IP header is found after it
+  ASSERT_EQ(rte_be_to_cpu_32(*rte_pktmbuf_mtod_offset(m, uint32_t *, 12)), 0x81000064U);
+  ASSERT_EQ(rte_be_to_cpu_16(*rte_pktmbuf_mtod_offset(m, uint16_t *, 16)), ETHER_TYPE_IPv4);
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, 18);
+  ASSERT_EQ(ipv4->type_of_service, (46 << 2) | 0x01);
+  ASSERT_EQ(ipv4->time_to_live, 63);
+  ASSERT_EQ(Ipv4ChecksumIsValid(ipv4), true);
+  rte_pktmbuf_free(m);
+}
+
+TEST(DecTtlAction, AfterPushMpls) {
+  auto m = InitIpv4Packet(64);
+  ASSERT_EQ(PreparePacket(m), true);
+  ExecutePushMpls(m, rte_cpu_to_be_32(0x00011140));
+  ASSERT_EQ(m->l2_len, 18);
+  ASSERT_EQ(ExecuteDecTtl(m), true);
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, 18);
+  ASSERT_EQ(ipv4->time_to_live, 63);
+  ASSERT_EQ(Ipv4ChecksumIsValid(ipv4), true);
+  rte_pktmbuf_free(m);
 }
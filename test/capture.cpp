@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <rte_cycles.h>
+#include "utils.h"
+#include "capture.h"
+
+TEST(PacketCapture, Pcap) {
+  const std::string file_name = "/tmp/dpdk_dpi_capture_test.pcap";
+  uint8_t data[64];
+  for (uint8_t i = 0; i < sizeof(data); ++i) {
+    data[i] = i;
+  }
+
+  PacketCapture &capture = PacketCapture::Instance();
+  int id = capture.Register(file_name);
+  ASSERT_GE(id, 0);
+  ASSERT_EQ(capture.Register(file_name), id);
+
+  // Segmented packet is captured as a whole, original packet may be freed before the clone
+  auto m = InitSegmentedPacket(data, sizeof(data), 20);
+  ASSERT_EQ(capture.Enqueue(id, m, rte_rdtsc()), true);
+  rte_pktmbuf_free(m);
+  capture.Write();
+  capture.Close();
+
+  std::ifstream file(file_name, std::ios::binary);
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  ASSERT_EQ(content.size(), 24 + 16 + sizeof(data));
+  ASSERT_EQ(*(const uint32_t *)content.data(), 0xa1b2c3d4U);
+  ASSERT_EQ(*(const uint32_t *)(content.data() + 24 + 8), sizeof(data));
+  ASSERT_EQ(*(const uint32_t *)(content.data() + 24 + 12), sizeof(data));
+  ASSERT_EQ(memcmp(content.data() + 24 + 16, data, sizeof(data)), 0);
+  remove(file_name.c_str());
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "clone_ring.h"
+
+static const uint8_t kPACKET[64] = {0};
+
+TEST(CloneRing, PortMbufsLimit) {
+  CloneRing ring;
+  ASSERT_EQ(ring.Create("CLONE_RING_TEST", 2 * kCLONE_PORT_MBUFS), true);
+  auto m = InitPacket(kPACKET, sizeof(kPACKET));
+  m->port = 1;
+  auto m_other = InitPacket(kPACKET, sizeof(kPACKET));
+  m_other->port = 2;
+
+  // Clones of single port keep limited number of its rx-mbufs, other ports aren't affected
+  for (uint32_t i = 0; i < kCLONE_PORT_MBUFS; ++i) {
+    ASSERT_EQ(ring.Enqueue(m, 0), true);
+  }
+  ASSERT_EQ(ring.Enqueue(m, 0), false);
+  ASSERT_EQ(ring.Enqueue(m_other, 0), true);
+
+  // Released clones return their mbufs, segmented packet needs room for all segments
+  rte_mbuf *pkts[2];
+  ASSERT_EQ(ring.Dequeue(pkts, 2), 2U);
+  CloneRing::Release(pkts[0]);
+  CloneRing::Release(pkts[1]);
+  auto m_segmented = InitSegmentedPacket(kPACKET, sizeof(kPACKET), 30);
+  m_segmented->port = 1;
+  ASSERT_EQ(m_segmented->nb_segs, 3);
+  ASSERT_EQ(ring.Enqueue(m_segmented, 0), false);
+  ASSERT_EQ(ring.Enqueue(m, 0), true);
+  ASSERT_EQ(ring.Enqueue(m, 0), true);
+  ASSERT_EQ(ring.Enqueue(m, 0), false);
+
+  // Clones left in ring are released when it's freed
+  ring.Free();
+  ASSERT_EQ(ring.Create("CLONE_RING_TEST", 2 * kCLONE_PORT_MBUFS), true);
+  ASSERT_EQ(ring.Enqueue(m_segmented, 0), true);
+  ring.Free();
+
+  rte_pktmbuf_free(m);
+  rte_pktmbuf_free(m_other);
+  rte_pktmbuf_free(m_segmented);
+}
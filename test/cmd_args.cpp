@@ -27,3 +27,121 @@ TEST(CmdArgs, ValidArgs) {
   ASSERT_EQ(cmd_args.stats_interval, 5);
   ASSERT_EQ(strcmp(cmd_args.config_file, "test_config.txt"), 0);
 }
+
+TEST(CmdArgs, MaxPktLen) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--max-pkt-len";
+  char arg2[] = "9000";
+  char *argv[] = {arg0, arg1, arg2};
+  int argc = 3;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.max_pkt_len, 9000);
+
+  char arg3[] = "70000";
+  argv[2] = arg3;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
+
+TEST(CmdArgs, TxRetries) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--tx-retries";
+  char arg2[] = "10";
+  char *argv[] = {arg0, arg1, arg2};
+  int argc = 3;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.tx_retries, 10);
+
+  char arg3[] = "-1";
+  argv[2] = arg3;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
+
+TEST(CmdArgs, BurstAndRings) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--burst";
+  char arg2[] = "64";
+  char arg3[] = "--rxd";
+  char arg4[] = "2048";
+  char arg5[] = "--mbufs";
+  char arg6[] = "65536";
+  char arg9[] = "--mempool-per-port";
+  char *argv[] = {arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg9};
+  int argc = 8;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.burst_size, 64);
+  ASSERT_EQ(cmd_args.nb_rxd, 2048);
+  ASSERT_EQ(cmd_args.nb_txd, 512);
+  ASSERT_EQ(cmd_args.nb_mbufs, 65536);
+  ASSERT_TRUE(cmd_args.mempool_per_port);
+
+  char arg7[] = "0";
+  argv[2] = arg7;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+
+  char arg8[] = "1024";
+  argv[2] = arg8;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
+
+TEST(CmdArgs, PortLcoreMap) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--port-lcore-map";
+  char arg2[] = "0:2,1:40";
+  char *argv[] = {arg0, arg1, arg2};
+  int argc = 3;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.port_lcore_map.size(), 2);
+  ASSERT_EQ(cmd_args.port_lcore_map.at(0), 2);
+  ASSERT_EQ(cmd_args.port_lcore_map.at(1), 40);
+
+  char arg3[] = "0:2,0:3";
+  argv[2] = arg3;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+
+  char arg4[] = "0-2";
+  argv[2] = arg4;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
+
+TEST(CmdArgs, Ipfix) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--ipfix";
+  char arg2[] = "127.0.0.1:4739";
+  char *argv[] = {arg0, arg1, arg2};
+  int argc = 3;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.ipfix_addr, 0x7f000001U);
+  ASSERT_EQ(cmd_args.ipfix_port, 4739);
+
+  char arg3[] = "127.0.0.1";
+  argv[2] = arg3;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+
+  char arg4[] = "127.0.0.0/8:4739";
+  argv[2] = arg4;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
+
+TEST(CmdArgs, FlowTableSize) {
+  char arg0[] = "./dpdk_dpi";
+  char arg1[] = "--flow-table-size";
+  char arg2[] = "65536";
+  char *argv[] = {arg0, arg1, arg2};
+  int argc = 3;
+
+  CmdArgs cmd_args = ParseArgs(argc, argv);
+  ASSERT_EQ(cmd_args.flow_table_size, 65536U);
+
+  char arg3[] = "1000";
+  argv[2] = arg3;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+
+  char arg4[] = "4";
+  argv[2] = arg4;
+  EXPECT_THROW(ParseArgs(argc, argv), std::invalid_argument);
+}
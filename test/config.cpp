@@ -1,4 +1,147 @@
 #include <gtest/gtest.h>
+#include "config.h"
 
 TEST(Config, Stub) {
 }
+
+TEST(Config, Ipv4Prefix) {
+  uint32_t addr;
+  uint8_t len;
+  ASSERT_EQ(ParseIpv4Prefix("10.1.2.3/8", addr, len), true);
+  ASSERT_EQ(addr, 0x0a000000U);
+  ASSERT_EQ(len, 8);
+  ASSERT_EQ(ParseIpv4Prefix("192.168.0.1", addr, len), true);
+  ASSERT_EQ(addr, 0xc0a80001U);
+  ASSERT_EQ(len, 32);
+  ASSERT_EQ(ParseIpv4Prefix("0.0.0.0/0", addr, len), true);
+  ASSERT_EQ(addr, 0U);
+  ASSERT_EQ(len, 0);
+
+  ASSERT_EQ(ParseIpv4Prefix("10.1.2.3/33", addr, len), false);
+  ASSERT_EQ(ParseIpv4Prefix("10.1.2/8", addr, len), false);
+  ASSERT_EQ(ParseIpv4Prefix("10.1.2.3/", addr, len), false);
+}
+
+TEST(Config, Range) {
+  uint16_t min, max;
+  ASSERT_EQ(ParseRange("5060", min, max), true);
+  ASSERT_EQ(min, 5060);
+  ASSERT_EQ(max, 5060);
+  ASSERT_EQ(ParseRange("1024-65535", min, max), true);
+  ASSERT_EQ(min, 1024);
+  ASSERT_EQ(max, 65535);
+
+  ASSERT_EQ(ParseRange("200-100", min, max), false);
+  ASSERT_EQ(ParseRange("1-65536", min, max), false);
+  ASSERT_EQ(ParseRange("-100", min, max), false);
+  ASSERT_EQ(ParseRange("a-b", min, max), false);
+}
+
+TEST(Config, EthAddr) {
+  ether_addr addr;
+  ASSERT_EQ(ParseEthAddr("00:1b:21:Aa:bB:ff", addr), true);
+  const uint8_t expected[] = {0x00, 0x1b, 0x21, 0xaa, 0xbb, 0xff};
+  ASSERT_EQ(memcmp(addr.addr_bytes, expected, sizeof(expected)), 0);
+
+  ASSERT_EQ(ParseEthAddr("00:1b:21:aa:bb", addr), false);
+  ASSERT_EQ(ParseEthAddr("00-1b-21-aa-bb-ff", addr), false);
+  ASSERT_EQ(ParseEthAddr("00:1b:21:aa:bb:fg", addr), false);
+}
+
+static AclKey MakeAclKey(const uint8_t port_id, const protocol_type protocol, const uint16_t vlan,
+                         const uint32_t src_addr, const uint32_t dst_addr,
+                         const uint16_t src_port, const uint16_t dst_port) {
+  AclKey key;
+  memset(&key, 0, sizeof(key));
+  key.port_id = port_id;
+  key.protocol = rte_cpu_to_be_16(protocol);
+  key.vlan = rte_cpu_to_be_16(vlan);
+  key.src_addr = rte_cpu_to_be_32(src_addr);
+  key.dst_addr = rte_cpu_to_be_32(dst_addr);
+  key.src_port = rte_cpu_to_be_16(src_port);
+  key.dst_port = rte_cpu_to_be_16(dst_port);
+  return key;
+}
+
+TEST(Config, RulePriority) {
+  RuleTable rules;
+
+  // 1: narrow prefix and port range
+  RuleConditions cond;
+  cond.protocol = SIP;
+  cond.src_addr = 0x0a010000;
+  cond.src_len = 16;
+  cond.dst_port_min = 5060;
+  cond.dst_port_max = 5061;
+  ASSERT_EQ(rules.Add(cond, Actions()), true);
+
+  // 2: wider prefix overlapping with the first rule
+  cond.src_addr = 0x0a000000;
+  cond.src_len = 8;
+  cond.dst_port_min = 5000;
+  cond.dst_port_max = 6000;
+  ASSERT_EQ(rules.Add(cond, Actions()), true);
+
+  // 3: any SIP packet with VLAN 100
+  cond = RuleConditions();
+  cond.protocol = SIP;
+  cond.vlan = 100;
+  ASSERT_EQ(rules.Add(cond, Actions()), true);
+
+  // 4: any SIP packet
+  cond = RuleConditions();
+  cond.protocol = SIP;
+  ASSERT_EQ(rules.Add(cond, Actions()), true);
+  ASSERT_EQ(rules.Add(cond, Actions()), false);
+  ASSERT_EQ(rules.Size(), 4U);
+  ASSERT_EQ(rules.Build(), true);
+
+  const AclKey keys[] = {
+    MakeAclKey(0, SIP, 100, 0x0a010203, 0x0b000001, 5060, 5060),   // all rules match
+    MakeAclKey(0, SIP, 100, 0x0a020203, 0x0b000001, 5060, 5060),   // outside of the first prefix
+    MakeAclKey(0, SIP, 100, 0x0a010203, 0x0b000001, 5060, 5062),   // outside of the first port range
+    MakeAclKey(0, SIP, 100, 0x0a010203, 0x0b000001, 5060, 7000),   // outside of both port ranges
+    MakeAclKey(0, SIP, 200, 0x0a010203, 0x0b000001, 5060, 7000),   // other VLAN
+    MakeAclKey(0, SIP, 0x1064, 0x0b010203, 0x0b000001, 5060, 7000),   // priority bits are ignored
+    MakeAclKey(0, HTTP, 100, 0x0a010203, 0x0b000001, 5060, 5060),  // other protocol
+    MakeAclKey(1, SIP, 100, 0x0a010203, 0x0b000001, 5060, 5060),   // other port
+  };
+  const uint32_t expected[] = {1, 2, 2, 3, 4, 3, 0, 0};
+  static constexpr uint32_t kKEYS_NUMBER = sizeof(keys) / sizeof(keys[0]);
+
+  const uint8_t *data[kKEYS_NUMBER];
+  for (uint32_t i = 0; i < kKEYS_NUMBER; ++i) {
+    data[i] = (const uint8_t *)&keys[i];
+  }
+  uint32_t results[kKEYS_NUMBER];
+  rules.Classify(data, results, kKEYS_NUMBER);
+  for (uint32_t i = 0; i < kKEYS_NUMBER; ++i) {
+    ASSERT_EQ(results[i], expected[i]) << "key " << i;
+    ASSERT_EQ(rules.GetActions(results[i]) != nullptr, expected[i] != 0);
+  }
+}
+
+TEST(Config, EmptyRuleTable) {
+  RuleTable rules;
+  ASSERT_EQ(rules.Build(), true);
+  const AclKey key = MakeAclKey(0, SIP, 0, 0x0a010203, 0x0b000001, 5060, 5060);
+  const uint8_t *data[] = {(const uint8_t *)&key};
+  uint32_t result = 1;
+  rules.Classify(data, &result, 1);
+  ASSERT_EQ(result, 0U);
+}
+
+TEST(Config, FlowSampling) {
+  RuleTable rules;
+  RuleConditions cond;
+  cond.protocol = SIP;
+  SampleAction *random = new SampleAction{SAMPLE, 10, false};
+  ASSERT_EQ(rules.Add(cond, Actions{reinterpret_cast<Action*>(random)}), true);
+  ASSERT_EQ(rules.HasFlowSampling(), false);
+
+  // Packets need flow key once any rule samples by flow
+  cond.protocol = RTP;
+  SampleAction *by_flow = new SampleAction{SAMPLE, 10, true};
+  ASSERT_EQ(rules.Add(cond, Actions{reinterpret_cast<Action*>(by_flow)}), true);
+  ASSERT_EQ(rules.HasFlowSampling(), true);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "flow_table.h"
+#include "flow_exporter.h"
+
+static constexpr uint32_t kTABLE_SIZE = 64;
+
+static void UpdateFlow(FlowTable &table, const FlowKey &key, const protocol_type protocol, const uint32_t rule,
+                       const uint32_t bytes, const uint64_t tsc) {
+  table.Update(key, GetFlowHash(key), protocol, rule, bytes, tsc);
+}
+
+// Timer ticks from first to last tsc inclusive
+static void ExpireFlows(FlowTable &table, const uint64_t first_tsc, const uint64_t last_tsc, const uint64_t step) {
+  for (uint64_t tsc = first_tsc; tsc <= last_tsc; tsc += step) {
+    table.Expire(tsc);
+  }
+}
+
+TEST(FlowTable, Expire) {
+  FlowTable table(1, kTABLE_SIZE, 100, 1000);
+  FlowRecord records[kTABLE_SIZE];
+
+  UpdateFlow(table, MakeFlowKey(1), SIP, 2, 100, 10);
+  UpdateFlow(table, MakeFlowKey(1), SIP, 2, 200, 50);
+  UpdateFlow(table, MakeFlowKey(2), RTP, 0, 300, 60);
+
+  // Flows are still active
+  ExpireFlows(table, 100, 100, 10);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 0U);
+
+  // The first flow is idle, the whole table is checked within idle timeout
+  UpdateFlow(table, MakeFlowKey(2), RTP, 0, 300, 160);
+  ExpireFlows(table, 110, 250, 10);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 1U);
+  const FlowKey key = MakeFlowKey(1);
+  ASSERT_EQ(memcmp(&records[0].key, &key, sizeof(key)), 0);
+  ASSERT_EQ(records[0].packets, 2U);
+  ASSERT_EQ(records[0].bytes, 300U);
+  ASSERT_EQ(records[0].first_tsc, 10U);
+  ASSERT_EQ(records[0].last_tsc, 50U);
+  ASSERT_EQ(records[0].rule, 2U);
+  ASSERT_EQ(records[0].port_id, 1);
+  ASSERT_EQ(records[0].protocol, SIP);
+
+  // Active timeout finishes long flows
+  for (uint64_t tsc = 200; tsc <= 1060; tsc += 20) {
+    UpdateFlow(table, MakeFlowKey(2), RTP, 0, 300, tsc);
+    ExpireFlows(table, tsc, tsc, 10);
+  }
+  ExpireFlows(table, 1070, 1160, 10);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 1U);
+  ASSERT_EQ(records[0].packets, 46U);
+
+  UpdateFlow(table, MakeFlowKey(3), HTTP, 0, 100, 1200);
+  table.ExpireAll();
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 1U);
+  ASSERT_EQ(table.GetDrops(), 0U);
+  ASSERT_EQ(table.GetEvictions(), 0U);
+}
+
+TEST(FlowTable, ExpireLargeTable) {
+  static constexpr uint32_t kLARGE_TABLE_SIZE = 1 << 14;
+  static constexpr uint32_t kFLOWS = 256;
+  FlowTable table(1, kLARGE_TABLE_SIZE, 1000, 1000000);
+  FlowRecord records[kFLOWS];
+
+  for (uint32_t i = 0; i < kFLOWS; ++i) {
+    FlowKey key = MakeFlowKey(i);
+    key.src_port = i;
+    UpdateFlow(table, key, SIP, 0, 100, 1000);
+  }
+  ExpireFlows(table, 1000, 1990, 10);
+  ASSERT_EQ(table.Dequeue(records, kFLOWS), 0U);
+
+  // Part of table proportional to elapsed time is checked at each tick
+  ExpireFlows(table, 2000, 2500, 10);
+  const uint32_t half = table.Dequeue(records, kFLOWS);
+  ASSERT_GT(half, 0U);
+  ASSERT_LT(half, kFLOWS);
+  ExpireFlows(table, 2510, 3000, 10);
+  ASSERT_EQ(half + table.Dequeue(records, kFLOWS), kFLOWS);
+  ASSERT_EQ(table.GetDrops(), 0U);
+}
+
+TEST(FlowTable, Eviction) {
+  FlowTable table(1, kTABLE_SIZE, 100, 1000);
+  FlowRecord records[kTABLE_SIZE];
+
+  // Flows of the same bucket don't finish each other until it's full
+  for (uint8_t i = 0; i < kFLOW_BUCKET_ENTRIES; ++i) {
+    table.Update(MakeFlowKey(i), 0, SIP, 0, 100, 10 + i);
+  }
+  table.Update(MakeFlowKey(0), 0, SIP, 0, 100, 20);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 0U);
+
+  // The least recently updated flow is finished for new one
+  table.Update(MakeFlowKey(100), 0, SIP, 0, 100, 30);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 1U);
+  FlowKey key = MakeFlowKey(1);
+  ASSERT_EQ(memcmp(&records[0].key, &key, sizeof(key)), 0);
+  ASSERT_EQ(table.GetEvictions(), 1U);
+
+  // Flow with another hash goes to other bucket
+  table.Update(MakeFlowKey(101), kFLOW_BUCKET_ENTRIES, SIP, 0, 100, 40);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), 0U);
+
+  table.ExpireAll();
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), kFLOW_BUCKET_ENTRIES + 1);
+  ASSERT_EQ(table.GetDrops(), 0U);
+}
+
+TEST(FlowTable, RingFull) {
+  FlowTable table(1, kTABLE_SIZE, 100, 1000);
+  FlowRecord records[kTABLE_SIZE];
+
+  // Exporter doesn't read records, the ring is as large as the table
+  for (uint32_t i = 0; i < 2*kTABLE_SIZE; ++i) {
+    table.Update(MakeFlowKey(i), 0, SIP, 0, 100, i);
+  }
+  table.ExpireAll();
+  ASSERT_EQ(table.GetEvictions(), 2*kTABLE_SIZE - kFLOW_BUCKET_ENTRIES);
+  ASSERT_EQ(table.GetDrops(), 2*kTABLE_SIZE - kTABLE_SIZE);
+  ASSERT_EQ(table.Dequeue(records, kTABLE_SIZE), kTABLE_SIZE);
+}
+
+TEST(FlowExporter, Message) {
+  FlowExporter exporter(0x7f000001, 4739);
+  FlowRecord record;
+  memset(&record, 0, sizeof(record));
+  record.key = MakeFlowKey(1);
+  record.packets = 2;
+  record.protocol = SIP;
+
+  const uint8_t *message;
+  exporter.AddRecord(record);
+  exporter.AddRecord(record);
+  uint16_t len = exporter.FinishMessage(message);
+
+  // Header, template set (2 templates) and data set of 2 IPv4 records
+  const uint16_t template_set_len = 4 + 2*(4 + 4*12 + 4);
+  const uint16_t record_len = 4 + 4 + 2 + 2 + 1 + 4 + 4 + 4*8 + 4;
+  ASSERT_EQ(len, 16 + template_set_len + 4 + 2*record_len);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)message), 10);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)(message + 2)), len);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)(message + 16)), 2);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)(message + 18)), template_set_len);
+  const uint8_t *data_set = message + 16 + template_set_len;
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)data_set), 256);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)(data_set + 2)), 4 + 2*record_len);
+  ASSERT_EQ(data_set[4], 10);
+
+  // The next message continues sequence and doesn't repeat templates
+  exporter.Reset();
+  record.key.ipv6 = 1;
+  exporter.AddRecord(record);
+  len = exporter.FinishMessage(message);
+  ASSERT_EQ(len, 16 + 4 + record_len + 2*12);
+  ASSERT_EQ(rte_be_to_cpu_32(*(const uint32_t *)(message + 8)), 2U);
+  ASSERT_EQ(rte_be_to_cpu_16(*(const uint16_t *)(message + 16)), 257);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "fragment_table.h"
+
+using namespace packet_modifier;
+
+TEST(FragmentTable, Ipv6Fragments) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0xdd,
+
+    0x60, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x2c, 0x40, // (payload len, next header=fragment, hop limit)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+
+    0x11, 0x00, 0x00, 0x01, // next header=UDP, offset=0, M=1
+    0x00, 0x00, 0x00, 0x07, // identification
+
+    0x13, 0xc4,
+    0x13, 0xc4,
+    0x00, 0x00,
+    0x00, 0x00,
+  };
+  FragmentTable table(100);
+  FragmentKey first_key, key;
+  bool first;
+  protocol_type protocol;
+
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l3_len, 40+8);
+  ASSERT_EQ(m->l4_len, 8);
+  ASSERT_EQ(GetFragmentKey(m, first_key, first), true);
+  ASSERT_EQ(first, true);
+  table.Add(first_key, SIP, 1000);
+  rte_pktmbuf_free(m);
+
+  // Non-first fragment of the same packet
+  data[56] = 0x00;
+  data[57] = 0x10; // offset=2, M=0
+  m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l4_len, 0);
+  ASSERT_EQ(GetFragmentKey(m, key, first), true);
+  ASSERT_EQ(first, false);
+  ASSERT_EQ(table.Lookup(key, 1050, protocol), true);
+  ASSERT_EQ(protocol, SIP);
+
+  // Entry is expired
+  ASSERT_EQ(table.Lookup(key, 1100, protocol), false);
+  rte_pktmbuf_free(m);
+
+  // Fragment of another packet
+  data[61] = 0x08;
+  m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(GetFragmentKey(m, key, first), true);
+  ASSERT_EQ(table.Lookup(key, 1050, protocol), false);
+  rte_pktmbuf_free(m);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include "utils.h"
+#include "heavy_hitters.h"
+
+using namespace packet_modifier;
+
+TEST(HeavyHitters, TopFlows) {
+  HeavyHitters heavy_hitters;
+  TopFlows top;
+
+  // Flow i sends i*100 bytes
+  for (uint8_t i = 1; i <= 2*kTOP_FLOWS; ++i) {
+    for (uint8_t j = 0; j < i; ++j) {
+      heavy_hitters.Update(MakeFlowKey(i), GetFlowHash(MakeFlowKey(i)), HTTP, 100);
+    }
+  }
+  heavy_hitters.Update(MakeFlowKey(100), GetFlowHash(MakeFlowKey(100)), SIP, 50);
+
+  heavy_hitters.GetTop(top);
+  ASSERT_EQ(top.count[HTTP], kTOP_FLOWS);
+  for (uint8_t i = 0; i < kTOP_FLOWS; ++i) {
+    ASSERT_EQ(top.flows[HTTP][i].key.src_addr[3], 2*kTOP_FLOWS - i);
+    ASSERT_GE(top.flows[HTTP][i].bytes, (2*kTOP_FLOWS - i)*100U);
+  }
+  ASSERT_EQ(top.count[SIP], 1);
+  ASSERT_EQ(top.flows[SIP][0].bytes, 50U);
+  ASSERT_EQ(top.count[RTP], 0);
+
+  // Window is finished
+  heavy_hitters.Publish();
+  heavy_hitters.GetPublished(top);
+  ASSERT_EQ(top.count[HTTP], kTOP_FLOWS);
+  heavy_hitters.GetTop(top);
+  ASSERT_EQ(top.count[HTTP], 0);
+}
+
+TEST(HeavyHitters, FlowKey) {
+  FlowKey key;
+
+  auto m = InitUdpPacket(1, 2, 5060, 53, std::string(4, '\0'));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(GetFlowKey(m, key), true);
+  ASSERT_EQ(key.src_port, 5060);
+  ASSERT_EQ(key.dst_port, 53);
+  ASSERT_EQ(key.proto, IPPROTO_UDP);
+  ASSERT_EQ(key.ipv6, 0);
+  ASSERT_EQ(FlowKeyToString(key), "10.0.0.1:5060 -> 10.0.0.2:53 proto=17");
+  rte_pktmbuf_free(m);
+}
+
+TEST(HeavyHitters, FlowKeyIpv6Fragment) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0xdd,
+
+    0x60, 0x00, 0x00, 0x00,
+    0x00, 0x10, 0x2c, 0x40, // (payload length, next header=fragment, hop limit)
+    0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02,
+
+    0x06, 0x00, 0x00, 0x08, // (next header=TCP, offset=8)
+    0x00, 0x00, 0x00, 0x01,
+
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  };
+  FlowKey key;
+
+  // Protocol of non-first fragment is taken from fragment header, it has no ports
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(GetFlowKey(m, key), true);
+  ASSERT_EQ(key.proto, IPPROTO_TCP);
+  ASSERT_EQ(key.ipv6, 1);
+  ASSERT_EQ(key.src_port, 0);
+  ASSERT_EQ(key.dst_port, 0);
+  ASSERT_EQ(FlowKeyToString(key), "2001:db8::1:0 -> 2001:db8::2:0 proto=6");
+  rte_pktmbuf_free(m);
+}
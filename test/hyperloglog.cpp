@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include "hyperloglog.h"
+
+TEST(HyperLogLog, Estimate) {
+  HyperLogLog hll;
+  ASSERT_EQ(hll.Estimate(), 0U);
+
+  // Duplicates aren't counted
+  for (uint32_t i = 0; i < 1000; ++i) {
+    hll.Add(i);
+    hll.Add(i);
+  }
+  ASSERT_NEAR(hll.Estimate(), 1000, 100);
+
+  for (uint32_t i = 1000; i < 100000; ++i) {
+    hll.Add(i);
+  }
+  ASSERT_NEAR(hll.Estimate(), 100000, 10000);
+
+  hll.Reset();
+  ASSERT_EQ(hll.Estimate(), 0U);
+}
+
+TEST(HyperLogLog, Merge) {
+  HyperLogLog hll1, hll2;
+  for (uint32_t i = 0; i < 20000; ++i) {
+    hll1.Add(i);
+  }
+  for (uint32_t i = 10000; i < 30000; ++i) {
+    hll2.Add(i);
+  }
+  hll1.Merge(hll2);
+  ASSERT_NEAR(hll1.Estimate(), 30000, 3000);
+}
+
+TEST(HyperLogLog, Cardinality) {
+  Cardinality cardinality;
+  uint64_t flows[kCARDINALITY_PROTOCOLS], clients[kCARDINALITY_PROTOCOLS];
+
+  // 500 flows from 10 clients
+  for (uint32_t i = 0; i < 500; ++i) {
+    cardinality.Update(SIP, i, i % 10);
+  }
+  cardinality.Publish();
+  cardinality.GetPublished(flows, clients);
+  ASSERT_NEAR(flows[SIP], 500, 50);
+  ASSERT_EQ(clients[SIP], 10U);
+  ASSERT_EQ(flows[HTTP], 0U);
+
+  // The next window is empty
+  cardinality.Publish();
+  cardinality.GetPublished(flows, clients);
+  ASSERT_EQ(flows[SIP], 0U);
+}
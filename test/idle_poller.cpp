@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+#include "idle_poller.h"
+
+TEST(IdlePoller, Escalation) {
+  IdlePoller poller(true);
+
+  for (int i = 1; i < kIDLE_PAUSE_POLLS; ++i) {
+    ASSERT_EQ(poller.Update(0), IDLE_POLL);
+  }
+  for (int i = kIDLE_PAUSE_POLLS; i < kIDLE_SLEEP_POLLS; ++i) {
+    ASSERT_EQ(poller.Update(0), IDLE_PAUSE);
+  }
+  for (int i = kIDLE_SLEEP_POLLS; i < kIDLE_INTR_POLLS; ++i) {
+    ASSERT_EQ(poller.Update(0), IDLE_SLEEP);
+  }
+  ASSERT_EQ(poller.Update(0), IDLE_WAIT_INTR);
+  ASSERT_EQ(poller.Update(0), IDLE_WAIT_INTR);
+
+  // Traffic returns to busy polling immediately
+  ASSERT_EQ(poller.Update(1), IDLE_POLL);
+  ASSERT_EQ(poller.Update(0), IDLE_POLL);
+}
+
+TEST(IdlePoller, NoInterrupts) {
+  IdlePoller poller(false);
+
+  for (int i = 1; i < 2*kIDLE_INTR_POLLS; ++i) {
+    poller.Update(0);
+  }
+  ASSERT_EQ(poller.Update(0), IDLE_SLEEP);
+}
+
+TEST(IdlePoller, SleepStageBound) {
+  IdlePoller poller(true);
+
+  uint32_t sleeps = 0;
+  idle_action action;
+  while ((action = poller.Update(0)) != IDLE_WAIT_INTR) {
+    sleeps += action == IDLE_SLEEP;
+  }
+
+  // Sleeping adds bounded latency and lasts ~100ms before lcore waits for interrupt
+  // (interrupt wait is limited too, so timers are still checked)
+  ASSERT_LE(kIDLE_SLEEP_US, 100);
+  ASSERT_GE(sleeps * kIDLE_SLEEP_US, 50000U);
+  ASSERT_LE(sleeps * kIDLE_SLEEP_US, 150000U);
+  ASSERT_LE(kIDLE_INTR_TIMEOUT_MS, 100);
+}
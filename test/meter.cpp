@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "meter.h"
+
+static constexpr uint64_t kTSC_HZ = 1000000000ULL;
+
+TEST(Meter, Conform) {
+  Meter meter(1000, 1500, kTSC_HZ);
+  uint64_t tsc = 5*kTSC_HZ;
+
+  // Bucket is full at start
+  ASSERT_EQ(meter.Conform(0, 1500, tsc), true);
+  ASSERT_EQ(meter.Conform(0, 1, tsc), false);
+
+  // 500 bytes are added in 0.5s
+  tsc += kTSC_HZ/2;
+  ASSERT_EQ(meter.Conform(0, 501, tsc), false);
+  ASSERT_EQ(meter.Conform(0, 499, tsc), true);
+
+  // Bucket doesn't exceed burst size
+  tsc += 100*kTSC_HZ;
+  ASSERT_EQ(meter.Conform(0, 1501, tsc), false);
+  ASSERT_EQ(meter.Conform(0, 1500, tsc), true);
+
+  // Other lcores have own buckets
+  ASSERT_EQ(meter.Conform(1, 1500, tsc), true);
+}
+
+TEST(Meter, HighRate) {
+  // 100 Gbit/s at 2 GHz
+  Meter meter(12500000000ULL, 100000, 2*kTSC_HZ);
+  uint64_t tsc = kTSC_HZ;
+  ASSERT_EQ(meter.Conform(0, 100000, tsc), true);
+  tsc += 1600; // 10000 bytes
+  ASSERT_EQ(meter.Conform(0, 9990, tsc), true);
+  ASSERT_EQ(meter.Conform(0, 100, tsc), false);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <rte_ip.h>
+#include "utils.h"
+#include "output_group.h"
+
+using namespace packet_modifier;
+
+TEST(OutputGroup, SymmetricHash) {
+  auto m = InitUdpPacket(1, 2, 5060, 40000);
+  ASSERT_EQ(PreparePacket(m), true);
+  const uint32_t hash = GetSymmetricFlowHash(m);
+  rte_pktmbuf_free(m);
+
+  // Reverse direction
+  m = InitUdpPacket(2, 1, 40000, 5060);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(GetSymmetricFlowHash(m), hash);
+
+  // NIC hash is ignored
+  m->ol_flags |= PKT_RX_RSS_HASH;
+  m->hash.rss = 12345;
+  ASSERT_EQ(GetSymmetricFlowHash(m), hash);
+  rte_pktmbuf_free(m);
+}
+
+// Fragment of UDP datagram, offset is in 8-byte units
+static rte_mbuf *InitUdpFragment(const uint8_t src_host, const uint8_t dst_host, const uint16_t src_port,
+                                 const uint16_t dst_port, const uint16_t offset, const bool more) {
+  auto m = InitUdpPacket(src_host, dst_host, src_port, dst_port);
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ipv4->fragment_offset = rte_cpu_to_be_16(offset | (more ? IPV4_HDR_MF_FLAG : 0));
+  ipv4->hdr_checksum = 0;
+  ipv4->hdr_checksum = rte_ipv4_cksum(ipv4);
+  return m;
+}
+
+TEST(OutputGroup, SymmetricHashFragments) {
+  // Data of non-first fragments takes place of ports, so they differ from ports of the first one
+  std::vector<rte_mbuf *> fragments = {
+    InitUdpFragment(1, 2, 5060, 40000, 0, true),
+    InitUdpFragment(1, 2, 1111, 2222, 1, true),
+    InitUdpFragment(1, 2, 3333, 4444, 2, false),
+    InitUdpFragment(2, 1, 40000, 5060, 0, true),
+    InitUdpFragment(2, 1, 5555, 6666, 1, false),
+  };
+  for (auto m : fragments) {
+    ASSERT_EQ(PreparePacket(m), true);
+  }
+  ASSERT_EQ(fragments[0]->packet_type & RTE_PTYPE_L4_MASK, RTE_PTYPE_L4_FRAG);
+  ASSERT_EQ(fragments[1]->l4_len, 0);
+
+  // All fragments of both directions go to the same port
+  const uint32_t hash = GetSymmetricFlowHash(fragments[0]);
+  for (auto m : fragments) {
+    ASSERT_EQ(GetSymmetricFlowHash(m), hash);
+    rte_pktmbuf_free(m);
+  }
+}
+
+TEST(OutputGroup, RendezvousHashing) {
+  const uint8_t ports[] = {0, 1, 2, 3};
+  bool link_up[] = {true, true, true, true};
+  const uint32_t nb_flows = 10000;
+  std::vector<int> selected(nb_flows);
+  unsigned counts[4] = {0};
+  for (uint32_t hash = 0; hash < nb_flows; ++hash) {
+    selected[hash] = SelectGroupPort(ports, link_up, 4, hash * 2654435761U);
+    ASSERT_GE(selected[hash], 0);
+    ++counts[selected[hash]];
+  }
+  for (auto count : counts) {
+    ASSERT_GT(count, nb_flows / 4 * 8 / 10);
+  }
+
+  // Only flows of the port which went down are moved
+  link_up[2] = false;
+  for (uint32_t hash = 0; hash < nb_flows; ++hash) {
+    const int index = SelectGroupPort(ports, link_up, 4, hash * 2654435761U);
+    ASSERT_NE(index, 2);
+    if (selected[hash] != 2) {
+      ASSERT_EQ(index, selected[hash]);
+    }
+  }
+
+  const bool all_down[] = {false, false, false, false};
+  ASSERT_EQ(SelectGroupPort(ports, all_down, 4, 1), -1);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "port.h"
+#include "utils.h"
+
+static constexpr uint16_t kBURST_SIZE = 32;
+static const uint8_t kPACKET[64] = {0};
+
+// NIC accepts limited number of packets per call, accepted ones are recorded and freed
+class PortStub : public PortEthernet {
+ public:
+  PortStub() : PortEthernet(0), accept_(0), calls_(0) {}
+
+  std::vector<uint8_t> sent_;
+  uint16_t accept_;
+  unsigned calls_;
+
+ protected:
+  virtual uint16_t TxBurst(rte_mbuf **pkts, const uint16_t nb_pkts) override {
+    ++calls_;
+    const uint16_t nb_tx = RTE_MIN(nb_pkts, accept_);
+    for (uint16_t i = 0; i < nb_tx; ++i) {
+      sent_.push_back(*rte_pktmbuf_mtod(pkts[i], uint8_t *));
+      rte_pktmbuf_free(pkts[i]);
+    }
+    return nb_tx;
+  }
+};
+
+// Packets are numbered by the first byte to check order of sending
+static void FillQueue(PortQueue &queue, const uint16_t count, uint8_t &number) {
+  for (uint16_t i = 0; i < count; ++i) {
+    rte_mbuf *m = InitPacket(kPACKET, sizeof(kPACKET));
+    *rte_pktmbuf_mtod(m, uint8_t *) = number++;
+    queue.queue_[queue.count_++] = m;
+  }
+}
+
+TEST(Port, TxRetriesExhausted) {
+  PortStub port;
+  port.SetBurstSize(kBURST_SIZE);
+  port.SetTxRetries(3);
+  PortQueue queue;
+  TxRing ring;
+  uint8_t number = 0;
+
+  // NIC is busy: the first attempt and all retries fail, packets wait in the ring
+  FillQueue(queue, 4, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.calls_, 4U);
+  ASSERT_EQ(queue.count_, 0);
+  ASSERT_EQ(ring.Count(), 4U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), 4U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), 0U);
+
+  // NIC accepts one packet per call, budget is shared by the ring and the queue
+  port.calls_ = 0;
+  port.accept_ = 1;
+  FillQueue(queue, 4, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.calls_, 5U);
+  ASSERT_EQ(port.sent_, std::vector<uint8_t>({0, 1, 2, 3, 4}));
+  ASSERT_EQ(ring.Count(), 3U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), 7U);
+}
+
+TEST(Port, TxDeferredSentFirst) {
+  PortStub port;
+  port.SetBurstSize(kBURST_SIZE);
+  PortQueue queue;
+  TxRing ring;
+  uint8_t number = 0;
+
+  port.accept_ = 2;
+  FillQueue(queue, 5, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.sent_, std::vector<uint8_t>({0, 1}));
+  ASSERT_EQ(ring.Count(), 3U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), 3U);
+
+  // New packets aren't sent while deferred ones are left, they are put after them
+  FillQueue(queue, 2, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.sent_, std::vector<uint8_t>({0, 1, 2, 3}));
+  ASSERT_EQ(ring.Count(), 3U);
+
+  port.accept_ = kBURST_SIZE;
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.sent_, std::vector<uint8_t>({0, 1, 2, 3, 4, 5, 6}));
+  ASSERT_EQ(ring.Count(), 0U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), 5U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), 0U);
+}
+
+TEST(Port, TxRingFull) {
+  PortStub port;
+  port.SetBurstSize(kBURST_SIZE);
+  PortQueue queue;
+  TxRing ring;
+  uint8_t number = 0;
+
+  for (uint32_t i = 0; i < kTX_RING_SIZE / kBURST_SIZE; ++i) {
+    FillQueue(queue, kBURST_SIZE, number);
+    port.SendAllPackets(&queue, &ring);
+  }
+  ASSERT_EQ(ring.Count(), kTX_RING_SIZE);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), 0U);
+
+  // Packets which don't fit into the ring are dropped
+  FillQueue(queue, kBURST_SIZE, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(queue.count_, 0);
+  ASSERT_EQ(ring.Count(), kTX_RING_SIZE);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), kTX_RING_SIZE);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), kBURST_SIZE);
+
+  // The oldest packets are sent, new ones take only the freed room
+  port.accept_ = kBURST_SIZE / 2;
+  FillQueue(queue, kBURST_SIZE, number);
+  port.SendAllPackets(&queue, &ring);
+  ASSERT_EQ(port.sent_.size(), kBURST_SIZE / 2U);
+  ASSERT_EQ(port.sent_.front(), 0);
+  ASSERT_EQ(ring.Count(), kTX_RING_SIZE);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), kTX_RING_SIZE + kBURST_SIZE / 2);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), kBURST_SIZE + kBURST_SIZE / 2);
+}
+
+TEST(Port, CountersOfAnyLcore) {
+  PortStub port;
+
+  // Lcores of the second socket usually have big ids
+  port.UpdateCounter(CNT_TX_DROPS, 2);
+  port.UpdateCounter(CNT_TX_DROPS, 40, 2);
+  port.UpdateCounter(CNT_TX_DROPS, RTE_MAX_LCORE - 1, 3);
+  port.UpdateProtocolStats(SIP, 40);
+  port.UpdateProtocolStats(SIP, RTE_MAX_LCORE - 1);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DROPS), 6U);
+  ASSERT_EQ(port.GetCounter(CNT_TX_DEFERRED), 0U);
+  ASSERT_EQ(port.GetProtocolStats(SIP), 2U);
+  ASSERT_EQ(port.GetProtocolStats(HTTP), 0U);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <rte_thash.h>
+#include "port_manager.h"
+
+TEST(PortManager, SymmetricRssKeyIpv4) {
+  std::mt19937 rng(1);
+  for (unsigned i = 0; i < 1000; ++i) {
+    uint32_t tuple[RTE_THASH_V4_L4_LEN] = {(uint32_t)rng(), (uint32_t)rng(), (uint32_t)rng()};
+    const uint32_t hash = rte_softrss(tuple, RTE_THASH_V4_L4_LEN, kSYMMETRIC_RSS_KEY);
+    // Addresses only are hashed for fragments
+    const uint32_t l3_hash = rte_softrss(tuple, 2, kSYMMETRIC_RSS_KEY);
+    // Swap addresses and ports, the whole hash is the same (not only its bits selecting queue)
+    std::swap(tuple[0], tuple[1]);
+    tuple[2] = (tuple[2] << 16) | (tuple[2] >> 16);
+    ASSERT_EQ(rte_softrss(tuple, RTE_THASH_V4_L4_LEN, kSYMMETRIC_RSS_KEY), hash);
+    ASSERT_EQ(rte_softrss(tuple, 2, kSYMMETRIC_RSS_KEY), l3_hash);
+  }
+}
+
+TEST(PortManager, SymmetricRssKeyIpv6) {
+  std::mt19937 rng(2);
+  for (unsigned i = 0; i < 1000; ++i) {
+    uint32_t tuple[RTE_THASH_V6_L4_LEN];
+    for (auto &word : tuple) {
+      word = rng();
+    }
+    const uint32_t hash = rte_softrss(tuple, RTE_THASH_V6_L4_LEN, kSYMMETRIC_RSS_KEY);
+    std::swap_ranges(tuple, tuple + 4, tuple + 4);
+    tuple[8] = (tuple[8] << 16) | (tuple[8] >> 16);
+    ASSERT_EQ(rte_softrss(tuple, RTE_THASH_V6_L4_LEN, kSYMMETRIC_RSS_KEY), hash);
+  }
+}
@@ -0,0 +1,384 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "common.h"
+
+extern protocol_type SearchHttp(rte_mbuf *);
+extern protocol_type SearchSip(rte_mbuf *);
+
+using namespace packet_modifier;
+
+TEST(PreparePacket, SegmentedHeaders) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x81, 0x00,
+    0x00, 0x64, // vid=100
+    0x08, 0x00,
+
+    0x46, 0x00, // ihl=6 (with options)
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x06, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x01, 0x01, 0x01, 0x01, // options
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x60, 0x00, // data_off=6 (with options)
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x01, 0x01, 0x01, 0x01, // options
+
+    0x00, 0x00, 0x00, 0x00, // payload
+  };
+  auto m = InitSegmentedPacket(data, sizeof(data), 10);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->l2_len, 18);
+  ASSERT_EQ(m->l3_len, 24);
+  ASSERT_EQ(m->l4_len, 24);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, TruncatedHeaders) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x06, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00, // TCP header without the rest
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), false);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, PacketTypeOffload) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x06, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x50, 0x00, // data_off=5
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+  };
+  auto m = InitPacket(data, sizeof(data));
+  m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP;
+  ASSERT_EQ(PreparePacket(m, true), true);
+  ASSERT_EQ(m->l2_len, 14);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 20);
+
+  // Not TCP/UDP packet is dropped by packet type
+  m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_ICMP;
+  ASSERT_EQ(PreparePacket(m, true), false);
+
+  // Unknown packet type - software parser is used
+  m->packet_type = RTE_PTYPE_UNKNOWN;
+  m->l2_len = m->l3_len = m->l4_len = 0;
+  ASSERT_EQ(PreparePacket(m, true), true);
+  ASSERT_EQ(m->l2_len, 14);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 20);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, VxlanTunnel) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x12, 0xb5, // dst port 4789
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x08, 0x00, 0x00, 0x00, // flags
+    0x00, 0x00, 0x01, 0x00, // vni
+
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x06, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x50,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x50, 0x00, // data_off=5
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x47, 0x45, 0x54, // GET
+    0x20, // space
+    0x2f, // /
+    0x20, // space
+    0x48, 0x54, 0x54, 0x50, // HTTP
+    0x2f, // /
+    0x31, 0x2e, 0x31, // 1.1
+    0x0d, 0x0a, // \r\n
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m, PREPARE_TUNNELS), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_TUNNEL_MASK, RTE_PTYPE_TUNNEL_VXLAN);
+  ASSERT_EQ(m->outer_l2_len, 14);
+  ASSERT_EQ(m->outer_l3_len, 20);
+  ASSERT_EQ(m->l2_len, 8+8+14);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 20);
+  ASSERT_EQ(SearchHttp(m), HTTP);
+
+  // Without tunnels parsing it's usual UDP packet
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->outer_l2_len, 0);
+  ASSERT_EQ(m->l2_len, 14);
+  ASSERT_EQ(SearchHttp(m), UNKNOWN);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, GtpuTunnel) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x08, 0x68, // dst port 2152
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x34, 0xff, // version=1, PT=1, E=1, G-PDU
+    0x00, 0x00, // length
+    0x00, 0x00, 0x00, 0x01, // teid
+    0x00, 0x00, 0x00, // sequence number, N-PDU number
+    0x85, // next extension type
+    0x01, 0x00, 0x01, 0x00, // extension (4 bytes), no next extension
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x13, 0xc4,
+    0x13, 0xc4,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x53, 0x49, 0x50, 0x2f, 0x32, 0x2e, 0x30, // SIP/2.0
+    0x20, // space
+    0x32, 0x30, 0x30, // 200
+    0x20, // space
+    0x4f, 0x4b, // OK
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m, PREPARE_TUNNELS), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_TUNNEL_MASK, RTE_PTYPE_TUNNEL_GTPU);
+  ASSERT_EQ(m->outer_l2_len, 14);
+  ASSERT_EQ(m->outer_l3_len, 20);
+  ASSERT_EQ(m->l2_len, 8+8+4+4);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 8);
+  ASSERT_EQ(SearchSip(m), SIP);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, GreTunnel) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x2f, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x20, 0x00, // K=1
+    0x08, 0x00, // IPv4
+    0x00, 0x00, 0x00, 0x01, // key
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x13, 0xc4,
+    0x13, 0xc4,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x53, 0x49, 0x50, 0x2f, 0x32, 0x2e, 0x30, // SIP/2.0
+    0x20, // space
+    0x32, 0x30, 0x30, // 200
+    0x20, // space
+    0x4f, 0x4b, // OK
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m, PREPARE_TUNNELS), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_TUNNEL_MASK, RTE_PTYPE_TUNNEL_GRE);
+  ASSERT_EQ(m->outer_l2_len, 14);
+  ASSERT_EQ(m->outer_l3_len, 20);
+  ASSERT_EQ(m->l2_len, 8);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 8);
+  ASSERT_EQ(SearchSip(m), SIP);
+
+  // GRE isn't supported without tunnels parsing
+  ASSERT_EQ(PreparePacket(m), false);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, Ipv6ExtHeaders) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x86, 0xdd,
+
+    0x60, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x40, // (payload len, next header=hop-by-hop, hop limit)
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+
+    0x2b, 0x00, 0x01, 0x04, 0x00, 0x00, 0x00, 0x00, // hop-by-hop (8 bytes), next header=routing
+    0x06, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // routing (16 bytes), next header=TCP
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x50, 0x00, // data_off=5
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_L3_MASK, RTE_PTYPE_L3_IPV6_EXT);
+  ASSERT_EQ(m->l2_len, 14);
+  ASSERT_EQ(m->l3_len, 40+8+16);
+  ASSERT_EQ(m->l4_len, 20);
+
+  // Extension header goes beyond the packet
+  m->pkt_len = m->data_len = 14+40+8+8;
+  ASSERT_EQ(PreparePacket(m), false);
+  rte_pktmbuf_free(m);
+}
+
+TEST(PreparePacket, Ipv4Fragments) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00,
+    0x00, 0x01,
+    0x20, 0x00, // MF=1, offset=0
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x13, 0xc4,
+    0x13, 0xc4,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x53, 0x49, 0x50, 0x2f, 0x32, 0x2e, 0x30, // SIP/2.0
+    0x20, // space
+    0x32, 0x30, 0x30, // 200
+    0x20, // space
+    0x4f, 0x4b, // OK
+  };
+  // First fragment has UDP header
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_L4_MASK, RTE_PTYPE_L4_FRAG);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 8);
+  ASSERT_EQ(SearchSip(m), SIP);
+  rte_pktmbuf_free(m);
+
+  // Non-first fragment doesn't have it
+  data[20] = 0x00;
+  data[21] = 0x02; // MF=0, offset=16
+  m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(m->packet_type & RTE_PTYPE_L4_MASK, RTE_PTYPE_L4_FRAG);
+  ASSERT_EQ(m->l3_len, 20);
+  ASSERT_EQ(m->l4_len, 0);
+  rte_pktmbuf_free(m);
+}
@@ -104,4 +104,69 @@ TEST(HTTP, Get) {
   rte_pktmbuf_free(m);
 }
 
+TEST(HTTP, GetWithoutVersion) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x05, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x47, 0x45, 0x54, // GET
+    0x20, // space
+    0x2f, 0x69, 0x6e, 0x64, 0x65, 0x78, // /index
+    0x2e, 0x68, 0x74, 0x6d, 0x6c, // .html
+    0x00, 0x00, 0x00, // other data (no space till the end)
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(SearchHttp(m), UNKNOWN);
+  rte_pktmbuf_free(m);
+}
+
+TEST(HTTP, TruncatedVersion) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x05, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x47, 0x45, 0x54, // GET
+    0x20, // space
+    0x2f, 0x69, 0x6e, 0x64, 0x65, 0x78, // /index
+    0x2e, 0x68, 0x74, 0x6d, 0x6c, // .html
+    0x20, // space
+    0x48, 0x54, 0x54, 0x50, // HTTP (without version)
+  };
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(SearchHttp(m), UNKNOWN);
+  rte_pktmbuf_free(m);
+}
+
 // TODO: other methods
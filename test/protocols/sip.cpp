@@ -501,3 +501,35 @@ TEST(SIP, Update) {
   ASSERT_EQ(SearchSip(m), SIP);
   rte_pktmbuf_free(m);
 }
+
+TEST(SIP, SegmentedRequest) {
+  uint8_t data[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x05, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+    0x00, 0x00,
+
+    0x52, 0x45, 0x47, 0x49, 0x53, 0x54, 0x45, 0x52, // REGISTER
+    0x20, // space
+    0x73, 0x69, 0x70, 0x3a, // sip:
+    0x00, 0x00, 0x00, // other data
+  };
+  // Second segment starts inside of prefix
+  auto m = InitSegmentedPacket(data, sizeof(data), sizeof(data) - 6);
+  ASSERT_EQ(PreparePacket(m), true);
+  ASSERT_EQ(SearchSip(m), SIP);
+  rte_pktmbuf_free(m);
+}
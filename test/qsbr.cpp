@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "qsbr.h"
+
+TEST(Qsbr, Synchronize) {
+  Qsbr qsbr;
+
+  // Offline readers aren't waited for
+  qsbr.Synchronize();
+
+  std::atomic<bool> stop(false);
+  std::atomic<bool> synchronized(false);
+  qsbr.Online(1);
+  std::thread writer([&] {
+    qsbr.Synchronize();
+    synchronized.store(true);
+  });
+  std::thread reader([&] {
+    while (!stop.load()) {
+      qsbr.Quiescent(1);
+    }
+    qsbr.Offline(1);
+  });
+
+  writer.join();
+  ASSERT_EQ(synchronized.load(), true);
+  stop.store(true);
+  reader.join();
+}
+
+TEST(Qsbr, WriterWaitsForOnlineReader) {
+  Qsbr qsbr;
+  std::atomic<bool> release(false);
+  std::atomic<bool> synchronized(false);
+
+  // Reader stays online without reporting quiescent state, like lcore inside a burst
+  qsbr.Online(2);
+  std::thread writer([&] {
+    qsbr.Synchronize();
+    synchronized.store(true);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(synchronized.load(), false);
+
+  std::thread reader([&] {
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+    qsbr.Quiescent(2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ASSERT_EQ(synchronized.load(), false);
+  release.store(true);
+  reader.join();
+  writer.join();
+  ASSERT_EQ(synchronized.load(), true);
+  qsbr.Offline(2);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "scheduler.h"
+
+TEST(EgressScheduler, Priority) {
+  uint8_t data[] = {0x00};
+  EgressScheduler scheduler;
+  rte_mbuf *http[4], *rtsp[4], *sip;
+  for (uint8_t i = 0; i < 4; ++i) {
+    http[i] = InitPacket(data, sizeof(data));
+    ASSERT_EQ(scheduler.Enqueue(http[i], HTTP), true);
+  }
+  for (uint8_t i = 0; i < 4; ++i) {
+    rtsp[i] = InitPacket(data, sizeof(data));
+    ASSERT_EQ(scheduler.Enqueue(rtsp[i], RTSP), true);
+  }
+  sip = InitPacket(data, sizeof(data));
+  ASSERT_EQ(scheduler.Enqueue(sip, SIP), true);
+  ASSERT_EQ(scheduler.Count(), 9U);
+
+  // Voice first, then 3:1 round robin
+  rte_mbuf *pkts[16];
+  ASSERT_EQ(scheduler.Dequeue(pkts, 6), 6);
+  ASSERT_EQ(pkts[0], sip);
+  ASSERT_EQ(pkts[1], rtsp[0]);
+  ASSERT_EQ(pkts[2], rtsp[1]);
+  ASSERT_EQ(pkts[3], rtsp[2]);
+  ASSERT_EQ(pkts[4], http[0]);
+  ASSERT_EQ(pkts[5], rtsp[3]);
+  for (uint8_t i = 0; i < 6; ++i) {
+    rte_pktmbuf_free(pkts[i]);
+  }
+
+  // Only bulk class is left
+  ASSERT_EQ(scheduler.Dequeue(pkts, 16), 3);
+  ASSERT_EQ(pkts[0], http[1]);
+  ASSERT_EQ(pkts[2], http[3]);
+  ASSERT_EQ(scheduler.Count(), 0U);
+  ASSERT_EQ(scheduler.Dequeue(pkts + 3, 16), 0);
+  for (uint8_t i = 0; i < 3; ++i) {
+    rte_pktmbuf_free(pkts[i]);
+  }
+}
+
+TEST(EgressScheduler, QueueLimit) {
+  uint8_t data[] = {0x00};
+  EgressScheduler scheduler;
+  for (uint16_t i = 0; i < kSCHED_QUEUE_SIZE; ++i) {
+    ASSERT_EQ(scheduler.Enqueue(InitPacket(data, sizeof(data)), HTTP), true);
+  }
+  auto m = InitPacket(data, sizeof(data));
+  ASSERT_EQ(scheduler.Enqueue(m, HTTP), false);
+  // Other class has own queue
+  ASSERT_EQ(scheduler.Enqueue(m, RTP), true);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "slow_path.h"
+
+using namespace packet_modifier;
+
+TEST(SlowPath, SampleRandom) {
+  ASSERT_EQ(SamplePacket(nullptr, 1, false), true);
+
+  unsigned sampled = 0;
+  for (unsigned i = 0; i < 10000; ++i) {
+    sampled += SamplePacket(nullptr, 4, false);
+  }
+  ASSERT_GT(sampled, 2000U);
+  ASSERT_LT(sampled, 3000U);
+}
+
+TEST(SlowPath, SampleFlow) {
+  // All packets of flow get the same decision, about 1/N flows are sampled
+  unsigned sampled = 0;
+  for (uint8_t host = 1; host < 255; ++host) {
+    const uint32_t flow_hash = GetFlowHash(MakeFlowKey(host));
+    const bool decision = SamplePacket(&flow_hash, 4, true);
+    for (unsigned i = 0; i < 10; ++i) {
+      ASSERT_EQ(SamplePacket(&flow_hash, 4, true), decision);
+    }
+    sampled += decision;
+  }
+  ASSERT_GT(sampled, 30U);
+  ASSERT_LT(sampled, 100U);
+
+  // Packets without flow key aren't sampled by flow
+  ASSERT_EQ(SamplePacket(nullptr, 1, true), false);
+}
+
+TEST(SlowPath, Analyze) {
+  // Own instance, so statistics don't depend on other users of the singleton
+  SlowPath slow_path;
+  ASSERT_EQ(slow_path.GetStats(), "");
+  ASSERT_EQ(slow_path.Initialize(), true);
+  ASSERT_EQ(slow_path.Initialize(), true);
+
+  // Original packets may be freed before the clones are analyzed
+  const char *payloads[] = {"INVITE sip:bob@example.com SIP/2.0\r\n", "INVITE sip:bob@example.com SIP/2.0\r\n",
+                            "SIP/2.0 200 OK\r\n", "BYE sip:bob@example.com SIP/2.0\r\n",
+                            "FOO sip:bob@example.com SIP/2.0\r\n", "BAR sip:bob@example.com SIP/2.0\r\n",
+                            "SIP/2.0 900 Unknown\r\n"};
+  for (auto payload : payloads) {
+    auto m = InitUdpPacket(1, 2, 5060, 5060, payload);
+    ASSERT_EQ(PreparePacket(m), true);
+    ASSERT_EQ(slow_path.Enqueue(m, SIP), true);
+    rte_pktmbuf_free(m);
+  }
+  slow_path.Process();
+
+  const std::string stats = slow_path.GetStats();
+  ASSERT_NE(stats.find("SIP: 7/"), std::string::npos);
+  ASSERT_NE(stats.find("/6\n"), std::string::npos); // distinct payloads
+  ASSERT_NE(stats.find("INVITE: 2"), std::string::npos);
+  ASSERT_NE(stats.find("BYE: 1"), std::string::npos);
+  ASSERT_NE(stats.find("2xx: 1"), std::string::npos);
+  // Unknown methods and status classes aren't counted separately
+  ASSERT_NE(stats.find("other: 3"), std::string::npos);
+  ASSERT_EQ(stats.find("FOO"), std::string::npos);
+  slow_path.Close();
+}
@@ -1,10 +1,15 @@
 #include "utils.h"
 #include <rte_memcpy.h>
 #include <rte_errno.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <netinet/in.h>
+#include <vector>
 
 static constexpr auto kTEST_MEMPOOL_NAME = "TEST_MEMPOOL_NAME";
 static constexpr auto kNB_MBUF = 4096;
-static constexpr auto kMBUF_SIZE = 256;
+static constexpr auto kMBUF_SIZE = sizeof(rte_mbuf) + RTE_MBUF_DEFAULT_BUF_SIZE;
 static constexpr auto kCACHE_SIZE = 64;
 
 static rte_mempool *GetMempoolForTest() {
@@ -38,3 +43,65 @@ rte_mbuf *InitPacket(const uint8_t data[], const uint16_t data_len) {
 
   return m;
 }
+
+rte_mbuf *InitSegmentedPacket(const uint8_t data[], const uint16_t data_len, const uint16_t seg_len) {
+  rte_mbuf *m = InitPacket(data, RTE_MIN(data_len, seg_len));
+  rte_mbuf *m_last = m;
+  for (uint16_t offset = seg_len; offset < data_len; offset += seg_len) {
+    rte_mbuf *seg = InitPacket(data + offset, RTE_MIN((uint16_t)(data_len - offset), seg_len));
+    m_last->next = seg;
+    m_last = seg;
+    m->pkt_len += seg->data_len;
+    ++m->nb_segs;
+  }
+
+  return m;
+}
+
+rte_mbuf *InitUdpPacket(const uint8_t src_host, const uint8_t dst_host, const uint16_t src_port,
+                        const uint16_t dst_port, const std::string &payload) {
+  std::vector<uint8_t> data = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00,
+
+    0x45, 0x00,
+    0x00, 0x00, // (total length)
+    0x00, 0x00,
+    0x00, 0x00,
+    0x40, 0x11, // (ttl, proto)
+    0x00, 0x00,
+    0x0a, 0x00, 0x00, src_host,
+    0x0a, 0x00, 0x00, dst_host,
+
+    (uint8_t)(src_port >> 8), (uint8_t)(src_port & 0xff),
+    (uint8_t)(dst_port >> 8), (uint8_t)(dst_port & 0xff),
+    0x00, 0x00, // (length)
+    0x00, 0x00,
+  };
+  const uint16_t ip_len = sizeof(ipv4_hdr) + sizeof(udp_hdr) + payload.length();
+  data[16] = ip_len >> 8;
+  data[17] = ip_len & 0xff;
+  data[38] = (ip_len - sizeof(ipv4_hdr)) >> 8;
+  data[39] = (ip_len - sizeof(ipv4_hdr)) & 0xff;
+  data.insert(data.end(), payload.begin(), payload.end());
+
+  rte_mbuf *m = InitPacket(data.data(), data.size());
+  auto ipv4 = rte_pktmbuf_mtod_offset(m, ipv4_hdr *, sizeof(ether_hdr));
+  ipv4->hdr_checksum = rte_ipv4_cksum(ipv4);
+
+  return m;
+}
+
+FlowKey MakeFlowKey(const uint8_t id) {
+  FlowKey key;
+  memset(&key, 0, sizeof(key));
+  key.src_addr[0] = 10;
+  key.src_addr[3] = id;
+  key.dst_addr[0] = 10;
+  key.dst_addr[3] = 254;
+  key.src_port = 5060;
+  key.dst_port = 5060;
+  key.proto = IPPROTO_UDP;
+  return key;
+}
@@ -1,9 +1,16 @@
 #ifndef UTILS_
 #define UTILS_
 
+#include <string>
 #include <rte_config.h>
 #include <rte_mbuf.h>
+#include "heavy_hitters.h"
 
 rte_mbuf *InitPacket(const uint8_t[], const uint16_t);
+rte_mbuf *InitSegmentedPacket(const uint8_t[], const uint16_t, const uint16_t);
+// Ethernet/IPv4/UDP packet between hosts 10.0.0.x with valid lengths and IPv4 checksum
+rte_mbuf *InitUdpPacket(const uint8_t, const uint8_t, const uint16_t, const uint16_t, const std::string & = "");
+// Key of UDP flow 10.0.0.id:5060 -> 10.0.0.254:5060
+FlowKey MakeFlowKey(const uint8_t);
 
 #endif // UTILS_